@@ -0,0 +1,70 @@
+// * ####################
+// * Arena
+// * ####################
+
+// * Linear (bump) allocator over a fixed buffer. Individual allocations are
+// * never freed, the whole arena is reset at once.
+struct Arena {
+  char *data;
+  size_t capacity;
+  size_t size;
+
+  // * Stats
+  size_t peak;         // * highest `size` ever reached
+  size_t allocs_count; // * allocations since the last reset
+  size_t resets_count;
+};
+
+Arena arena_from_buffer(char *buffer, size_t capacity) {
+  Arena arena = {};
+  arena.data = buffer;
+  arena.capacity = capacity;
+  return arena;
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t align = alignof(std::max_align_t)) {
+  assert(arena);
+  assert(align > 0 && (align & (align - 1)) == 0);
+
+  const size_t begin = (arena->size + align - 1) & ~(align - 1);
+  if (begin + size > arena->capacity) {
+    fprintf(stderr, "ERROR: arena overflow: requested %zu bytes with %zu/%zu bytes used\n",
+            size, arena->size, arena->capacity);
+    abort();
+  }
+
+  arena->size = begin + size;
+  arena->peak = std::max(arena->peak, arena->size);
+  arena->allocs_count += 1;
+  return arena->data + begin;
+}
+
+// * Zero initialized array of `count` elements of T
+template <typename T>
+T *arena_alloc_array(Arena *arena, size_t count) {
+  T *result = (T*) arena_alloc(arena, sizeof(T) * count, alignof(T));
+  memset((void*) result, 0, sizeof(T) * count);
+  return result;
+}
+
+void arena_reset(Arena *arena) {
+  assert(arena);
+  arena->size = 0;
+  arena->allocs_count = 0;
+  arena->resets_count += 1;
+}
+
+// * Long lived asset data (animat frames, ...). Never reset.
+const size_t ASSET_ARENA_CAPACITY = 64 * 1024;
+// * Temporaries while loading an asset (decoded png pixels, ...). Reset after every load.
+const size_t SCRATCH_ARENA_CAPACITY = 2 * 1024 * 1024;
+// * Temporaries that live for a single frame. Reset at the beginning of every frame.
+const size_t FRAME_ARENA_CAPACITY = 1024 * 1024;
+
+alignas(std::max_align_t) char asset_arena_buffer[ASSET_ARENA_CAPACITY];
+alignas(std::max_align_t) char scratch_arena_buffer[SCRATCH_ARENA_CAPACITY];
+alignas(std::max_align_t) char frame_arena_buffer[FRAME_ARENA_CAPACITY];
+
+Arena asset_arena = arena_from_buffer(asset_arena_buffer, ASSET_ARENA_CAPACITY);
+Arena scratch_arena = arena_from_buffer(scratch_arena_buffer, SCRATCH_ARENA_CAPACITY);
+Arena frame_arena = arena_from_buffer(frame_arena_buffer, FRAME_ARENA_CAPACITY);
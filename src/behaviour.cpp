@@ -0,0 +1,295 @@
+// * ####################
+// * Behaviour
+// * ####################
+
+// * Entity scripts written as C++20 coroutines. A behaviour suspends while it
+// * waits and sits in a timer wheel slot until its tick comes, so waiting
+// * entities cost nothing per tick. Scripts never touch the World directly,
+// * they issue orders into the Tick_Input of the tick, so everything they do
+// * is recorded and replayed by the rollback like the player's input.
+
+struct Behaviour_Promise;
+typedef std::coroutine_handle<Behaviour_Promise> Behaviour_Handle;
+
+// * Coroutine frames come from a fixed pool of blocks instead of the heap, a
+// * patrol awaits a fresh sub-behaviour every few ticks. Single threaded like
+// * the scheduler.
+const size_t BEHAVIOUR_FRAME_SIZE = 1024;
+const size_t BEHAVIOUR_FRAMES_CAPACITY = 64;
+
+union Behaviour_Frame {
+  Behaviour_Frame *next; // * while free
+  alignas(std::max_align_t) char data[BEHAVIOUR_FRAME_SIZE];
+};
+
+struct Behaviour_Frame_Pool {
+  Behaviour_Frame frames[BEHAVIOUR_FRAMES_CAPACITY];
+  Behaviour_Frame *free_list;
+  size_t used; // * frames handed out at least once, the rest were never touched
+};
+
+Behaviour_Frame_Pool behaviour_frames = {};
+
+void *alloc_behaviour_frame(size_t size) {
+  if (size > BEHAVIOUR_FRAME_SIZE) {
+    fprintf(stderr, "ERROR: behaviour frame of %zu bytes, blocks are %zu bytes\n",
+            size, BEHAVIOUR_FRAME_SIZE);
+    abort();
+  }
+
+  Behaviour_Frame *frame = behaviour_frames.free_list;
+  if (frame) {
+    behaviour_frames.free_list = frame->next;
+  } else if (behaviour_frames.used < BEHAVIOUR_FRAMES_CAPACITY) {
+    frame = &behaviour_frames.frames[behaviour_frames.used++];
+  } else {
+    fprintf(stderr, "ERROR: out of behaviour frames (%zu)\n", BEHAVIOUR_FRAMES_CAPACITY);
+    abort();
+  }
+  return frame;
+}
+
+void free_behaviour_frame(void *p) {
+  Behaviour_Frame *frame = (Behaviour_Frame*) p;
+  frame->next = behaviour_frames.free_list;
+  behaviour_frames.free_list = frame;
+}
+
+// * Owns the coroutine. A behaviour can co_await another one to run it as a
+// * sub-behaviour, the child is destroyed together with the awaiting temporary.
+struct Behaviour {
+  using promise_type = Behaviour_Promise;
+  Behaviour_Handle handle;
+
+  Behaviour(Behaviour_Handle handle): handle(handle) {}
+  Behaviour(Behaviour &&other): handle(std::exchange(other.handle, {})) {}
+  Behaviour(const Behaviour&) = delete;
+  Behaviour &operator=(const Behaviour&) = delete;
+  ~Behaviour() {
+    if (handle) handle.destroy();
+  }
+
+  bool await_ready() { return false; }
+  Behaviour_Handle await_suspend(Behaviour_Handle caller);
+  void await_resume() {}
+};
+
+struct Behaviour_Promise {
+  static void *operator new(size_t size) { return alloc_behaviour_frame(size); }
+  static void operator delete(void *p) noexcept { free_behaviour_frame(p); }
+
+  uint64_t wake_tick;
+  Behaviour_Promise *next;  // * next behaviour in the same timer wheel slot
+  Behaviour_Handle parent;  // * behaviour awaiting this one, if any
+  Behaviour_Promise *root;  // * outermost behaviour, owned by the scheduler
+
+  // * Continues the awaiting parent, or goes back to the scheduler
+  struct Final_Awaiter {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(Behaviour_Handle handle) noexcept {
+      Behaviour_Handle parent = handle.promise().parent;
+      if (parent) return parent;
+      return std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+
+  Behaviour get_return_object() { return {Behaviour_Handle::from_promise(*this)}; }
+  // * Started by the scheduler or by the co_await of the parent
+  std::suspend_always initial_suspend() { return {}; }
+  Final_Awaiter final_suspend() noexcept { return {}; }
+  void return_void() {}
+  void unhandled_exception() {
+    fprintf(stderr, "ERROR: unhandled exception in a behaviour\n");
+    abort();
+  }
+};
+
+Behaviour_Handle Behaviour::await_suspend(Behaviour_Handle caller) {
+  Behaviour_Promise *child = &handle.promise();
+  child->parent = caller;
+  child->root = caller.promise().root;
+  return handle;
+}
+
+// * Power of two, waits longer than this just stay in their slot for extra
+// * turns of the wheel
+const size_t TIMER_WHEEL_SLOTS = 256;
+
+struct Scheduler {
+  uint64_t tick;
+  Behaviour_Promise *wheel[TIMER_WHEEL_SLOTS];
+  size_t behaviours_count; // * running root behaviours
+
+  // * Stats
+  size_t resumed_count; // * behaviours resumed on the last tick
+
+  // * Only valid inside scheduler_tick()
+  const World *world;
+  Tick_Input *input;
+};
+
+static inline
+void schedule_behaviour(Scheduler *scheduler, Behaviour_Promise *promise) {
+  Behaviour_Promise **slot = &scheduler->wheel[promise->wake_tick & (TIMER_WHEEL_SLOTS - 1)];
+  promise->next = *slot;
+  *slot = promise;
+}
+
+// * The scheduler takes over the behaviour and runs it from the next tick on
+void start_behaviour(Scheduler *scheduler, Behaviour behaviour) {
+  assert(scheduler);
+  assert(behaviour.handle);
+
+  Behaviour_Promise *promise = &behaviour.handle.promise();
+  promise->root = promise;
+  promise->wake_tick = scheduler->tick;
+  schedule_behaviour(scheduler, promise);
+  scheduler->behaviours_count += 1;
+  behaviour.handle = {};
+}
+
+// * Resumes the behaviours due this tick. Their orders go into `input`.
+void scheduler_tick(Scheduler *scheduler, const World *world, Tick_Input *input) {
+  assert(scheduler);
+  scheduler->world = world;
+  scheduler->input = input;
+  scheduler->resumed_count = 0;
+
+  Behaviour_Promise **slot = &scheduler->wheel[scheduler->tick & (TIMER_WHEEL_SLOTS - 1)];
+  Behaviour_Promise *promise = *slot;
+  *slot = nullptr;
+
+  while (promise) {
+    Behaviour_Promise *next = promise->next;
+    if (promise->wake_tick > scheduler->tick) {
+      // * Not this turn of the wheel
+      schedule_behaviour(scheduler, promise);
+    } else {
+      // * Resuming may finish and destroy sub-behaviours, not the root
+      Behaviour_Promise *root = promise->root;
+      Behaviour_Handle::from_promise(*promise).resume();
+      scheduler->resumed_count += 1;
+
+      Behaviour_Handle root_handle = Behaviour_Handle::from_promise(*root);
+      if (root_handle.done()) {
+        root_handle.destroy();
+        scheduler->behaviours_count -= 1;
+      }
+    }
+    promise = next;
+  }
+
+  scheduler->world = nullptr;
+  scheduler->input = nullptr;
+  scheduler->tick += 1;
+}
+
+void destroy_scheduler(Scheduler *scheduler) {
+  assert(scheduler);
+  for (size_t i = 0; i < TIMER_WHEEL_SLOTS; ++i) {
+    for (Behaviour_Promise *promise = scheduler->wheel[i]; promise; ) {
+      Behaviour_Promise *next = promise->next;
+      // * Destroying the root destroys the awaited sub-behaviours with it
+      Behaviour_Handle::from_promise(*promise->root).destroy();
+      promise = next;
+    }
+    scheduler->wheel[i] = nullptr;
+  }
+  scheduler->behaviours_count = 0;
+}
+
+// * ####################
+// * Behaviour primitives
+// * ####################
+
+struct Wait_Ticks {
+  Scheduler *scheduler;
+  uint64_t ticks;
+
+  bool await_ready() { return false; }
+  void await_suspend(Behaviour_Handle handle) {
+    Behaviour_Promise *promise = &handle.promise();
+    promise->wake_tick = scheduler->tick + ticks;
+    schedule_behaviour(scheduler, promise);
+  }
+  void await_resume() {}
+};
+
+// * Suspends the behaviour for `ticks` ticks, at least one
+Wait_Ticks wait_ticks(Scheduler *scheduler, uint64_t ticks) {
+  assert(scheduler);
+  assert(ticks >= 1);
+  return {scheduler, ticks};
+}
+
+static inline
+const Entity *get_behaviour_entity(const Scheduler *scheduler, size_t entity) {
+  assert(scheduler->world);
+  assert(entity < scheduler->world->entities_count);
+  return &scheduler->world->entities[entity];
+}
+
+void issue_order(Scheduler *scheduler, size_t entity, Entity_Order order) {
+  assert(scheduler->input);
+  push_entity_command(scheduler->input, entity, order);
+}
+
+// * Sleeps until the entity stands on something
+Behaviour wait_until_grounded(Scheduler *scheduler, size_t entity) {
+  while (!is_entity_on_ground(&scheduler->world->level, get_behaviour_entity(scheduler, entity))) {
+    co_await wait_ticks(scheduler, 1);
+  }
+}
+
+// * Walks until a wall stops the entity or the next step would be off a
+// * ledge. The velocity is not a reliable wall signal (small impacts keep
+// * it), so it watches the position instead. The caller is expected to
+// * stop the entity right after, in the same tick.
+Behaviour move_until_blocked(Scheduler *scheduler, size_t entity, Entity_Dir dir) {
+  issue_order(scheduler, entity,
+              dir == Entity_Dir::Right ? Entity_Order::Move_Right : Entity_Order::Move_Left);
+  for (;;) {
+    const Entity *e = get_behaviour_entity(scheduler, entity);
+    if (!is_ground_ahead(&scheduler->world->level, e, dir)) break;
+
+    const Fixed x = e->pos.x;
+    co_await wait_ticks(scheduler, 1);
+    if (get_behaviour_entity(scheduler, entity)->pos.x == x) break;
+  }
+}
+
+// * Sleeps through the weapon cooldown, then shoots
+Behaviour shoot_on_cooldown(Scheduler *scheduler, size_t entity) {
+  const int cooldown = get_behaviour_entity(scheduler, entity)->weapon_cooldown;
+  if (cooldown > 0) {
+    co_await wait_ticks(scheduler, (uint64_t)cooldown);
+  }
+  issue_order(scheduler, entity, Entity_Order::Shoot);
+}
+
+const uint64_t PATROL_REST_TICKS = 60;
+
+// * Walks between walls & ledges, resting and shooting at every turn
+Behaviour patrol_behaviour(Scheduler *scheduler, size_t entity) {
+  Entity_Dir dir = Entity_Dir::Right;
+  for (;;) {
+    co_await wait_until_grounded(scheduler, entity);
+    co_await move_until_blocked(scheduler, entity, dir);
+    issue_order(scheduler, entity, Entity_Order::Stop);
+    co_await wait_ticks(scheduler, PATROL_REST_TICKS);
+    co_await shoot_on_cooldown(scheduler, entity);
+    dir = dir == Entity_Dir::Right ? Entity_Dir::Left : Entity_Dir::Right;
+  }
+}
+
+// * Scripted guards patrolling the pit on the left and the ledge on the
+// * right of the level, spawned in empty tiles right above the floor
+void spawn_patrol_guards(Scheduler *scheduler, World *world, const World_Assets *assets) {
+  const Vec2i patrol_tiles[] = {vec2(2, 3), vec2(9, 3)};
+  for (Vec2i tile : patrol_tiles) {
+    assert(is_tile_standable(&world->level, tile));
+    spawn_entity(world, assets, get_tile_centre(tile))->scripted = true;
+    start_behaviour(scheduler, patrol_behaviour(scheduler, world->entities_count - 1));
+  }
+}
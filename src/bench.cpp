@@ -0,0 +1,511 @@
+// * ##################################
+// * Kernel Benchmarks
+// * ##################################
+
+// * Same single compilation unit as the game without main.cpp, so the
+// * kernels are the same code as in the game. The numbers are for -O2 (see
+// * the Makefile) like a release build, the `game` target itself is built
+// * without optimizations for debugging. Runs headless, no window or
+// * renderer is created.
+// *
+// * $ bench [--format text|csv|json] [--filter <substring>] [--min-time <ms>] [--seed <n>]
+
+#define SCU_NO_MAIN
+#include "scu.cpp"
+
+#include <new>
+
+// * ####################
+// * Allocation counting
+// * ####################
+
+// * Every heap allocation of the process goes through here. The arenas are
+// * counted separately from their own stats.
+size_t bench_heap_allocs_count = 0;
+
+void *operator new(size_t size) {
+  bench_heap_allocs_count += 1;
+  void *result = malloc(size ? size : 1);
+  if (!result) throw std::bad_alloc();
+  return result;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static inline
+size_t get_arena_allocs_count() {
+  return asset_arena.allocs_count + scratch_arena.allocs_count + frame_arena.allocs_count;
+}
+
+// * Keeps the compiler from dropping the work of a benchmark
+volatile int64_t bench_sink = 0;
+
+// * ####################
+// * Benchmark inputs
+// * ####################
+
+// * The level has a fixed size, the map "size" is the side of the square of
+// * tiles that gets randomly filled and sampled, the rest stays empty
+const int BENCH_MAP_SIZES[] = {4, 7, LEVEL_WIDTH};
+const int BENCH_DENSITIES[] = {10, 30, 60}; // * percent of walls
+
+const size_t BENCH_SAMPLES_COUNT = 1024; // * power of two
+const size_t BENCH_ANIMATS_COUNT = 1024;
+const size_t BENCH_VECTORS_COUNT = 1024;
+// * Updated in rounds, the refills between rounds are not measured
+const size_t BENCH_POOLS_COUNT = 16;
+
+// * Same boxes as the player
+const SDL_Rect BENCH_HITBOX = {-19, -19, 28, 38};
+const Uint64 BENCH_TICK_DT = 16;
+
+struct Bench_Context {
+  uint32_t rng;
+  int map_size;
+  int density;
+
+  Level level;
+  Vec2i points[BENCH_SAMPLES_COUNT];
+  Entity entities[BENCH_SAMPLES_COUNT];
+  Projectile_Pool projectiles[BENCH_POOLS_COUNT];
+  Animat animats[BENCH_ANIMATS_COUNT];
+  Vec2i vectors_i[BENCH_VECTORS_COUNT];
+  Vec2x vectors_x[BENCH_VECTORS_COUNT];
+  Vec2x velocities_x[BENCH_VECTORS_COUNT];
+  size_t vectors_count; // * batch size, a runtime value like in the game
+
+  // * Whole frames
+  World_Assets assets;
+  World world;
+  Scheduler scheduler;
+  Particle_Pool particles;
+  Bot bot;
+
+  // * Setup work done inside a benchmark, subtracted from its time
+  double untimed_ns;
+};
+
+static inline
+double get_elapsed_ns(Uint64 begin) {
+  return (double)(SDL_GetPerformanceCounter() - begin) * 1e9 / (double)SDL_GetPerformanceFrequency();
+}
+
+static inline
+int random_int(uint32_t *rng, int n) {
+  return (int)(xorshift32(rng) % (uint32_t)n);
+}
+
+static inline
+Vec2i random_map_point(Bench_Context *ctx) {
+  const int side = ctx->map_size * TILE_SIZE;
+  return vec2(random_int(&ctx->rng, side), random_int(&ctx->rng, side));
+}
+
+void generate_bench_map(Bench_Context *ctx, int map_size, int density) {
+  ctx->map_size = map_size;
+  ctx->density = density;
+
+  Tile tiles[LEVEL_HEIGHT][LEVEL_WIDTH] = {};
+  for (int y = 0; y < map_size; ++y) {
+    for (int x = 0; x < map_size; ++x) {
+      tiles[y][x] = random_int(&ctx->rng, 100) < density ? Tile::Wall : Tile::Empty;
+    }
+  }
+  init_level(&ctx->level, tiles);
+
+  for (size_t i = 0; i < BENCH_SAMPLES_COUNT; ++i) {
+    ctx->points[i] = random_map_point(ctx);
+
+    Entity *entity = &ctx->entities[i];
+    *entity = {};
+    entity->hitbox = BENCH_HITBOX;
+    entity->pos = vec2_fixed(random_map_point(ctx));
+    entity->vel = vec2(fixed(random_int(&ctx->rng, 5) - 2), fixed(random_int(&ctx->rng, 21) - 10));
+  }
+}
+
+void generate_bench_data(Bench_Context *ctx) {
+  ctx->vectors_count = BENCH_VECTORS_COUNT;
+  for (size_t i = 0; i < BENCH_ANIMATS_COUNT; ++i) {
+    const uint64_t duration = 50 + (uint64_t)random_int(&ctx->rng, 200);
+    ctx->animats[i] = {nullptr, 1 + (size_t)random_int(&ctx->rng, 8), 0, duration, duration};
+  }
+  for (size_t i = 0; i < BENCH_VECTORS_COUNT; ++i) {
+    ctx->vectors_i[i] = vec2(random_int(&ctx->rng, 2000) - 1000, random_int(&ctx->rng, 2000) - 1000);
+    ctx->vectors_x[i] = vec2(Fixed{random_int(&ctx->rng, 1 << 20) - (1 << 19)},
+                             Fixed{random_int(&ctx->rng, 1 << 20) - (1 << 19)});
+    ctx->velocities_x[i] = vec2(Fixed{random_int(&ctx->rng, 1024) - 512},
+                                Fixed{random_int(&ctx->rng, 1024) - 512});
+  }
+}
+
+// * The level of the game with its guards, the player is played by a bot
+void init_bench_frame(Bench_Context *ctx) {
+  ctx->assets = headless_world_assets();
+  init_world(&ctx->world, &ctx->assets);
+  spawn_patrol_guards(&ctx->scheduler, &ctx->world, &ctx->assets);
+  init_particles(&ctx->particles);
+  ctx->bot = make_bot(ctx->rng);
+}
+
+// * Fills every free slot of the pools, like a heavy firefight
+static inline
+void refill_bench_projectiles(Bench_Context *ctx) {
+  for (size_t j = 0; j < BENCH_POOLS_COUNT; ++j) {
+    Projectile_Pool *pool = &ctx->projectiles[j];
+    for (size_t i = 0; i < projectiles_count; ++i) {
+      if (pool->projectiles[i].state == Projectile_State::Ded) {
+        const Vec2i vel = vec2(random_int(&ctx->rng, 2) ? 4 : -4, 0);
+        spwan_projectile(pool, random_map_point(ctx), vel);
+      }
+    }
+  }
+}
+
+void init_bench_projectiles(Bench_Context *ctx) {
+  for (size_t j = 0; j < BENCH_POOLS_COUNT; ++j) {
+    init_projectiles(&ctx->projectiles[j], {nullptr, 5, 0, 200, 0});
+  }
+  refill_bench_projectiles(ctx);
+}
+
+// * ####################
+// * Benchmarks
+// * ####################
+
+// * Runs `ops` operations of the kernel
+typedef void (*Bench_Fn)(Bench_Context *ctx, uint64_t ops);
+
+void bench_resolve_point_collision(Bench_Context *ctx, uint64_t ops) {
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; ++i) {
+    Vec2i p = ctx->points[i & (BENCH_SAMPLES_COUNT - 1)];
+    resolve_point_collision(&ctx->level, &p);
+    sum += p.x + p.y;
+  }
+  bench_sink = bench_sink + sum;
+}
+
+void bench_resolve_entity_collision(Bench_Context *ctx, uint64_t ops) {
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; ++i) {
+    Entity entity = ctx->entities[i & (BENCH_SAMPLES_COUNT - 1)];
+    resolve_entity_collision(&ctx->level, &entity);
+    sum += entity.pos.x.raw + entity.pos.y.raw;
+  }
+  bench_sink = bench_sink + sum;
+}
+
+// * One op is one update of a whole pool. The projectiles that hit a wall
+// * are spawned again after every round over the pools, outside of the
+// * measured time.
+void bench_update_projectiles(Bench_Context *ctx, uint64_t ops) {
+  int64_t impacts = 0;
+  for (uint64_t i = 0; i < ops; i += BENCH_POOLS_COUNT) {
+    for (size_t j = 0; j < BENCH_POOLS_COUNT; ++j) {
+      update_projectiles(&ctx->projectiles[j], &ctx->level, BENCH_TICK_DT);
+      impacts += (int64_t)ctx->projectiles[j].impacts_count;
+    }
+
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    refill_bench_projectiles(ctx);
+    ctx->untimed_ns += get_elapsed_ns(begin);
+  }
+  bench_sink = bench_sink + impacts;
+}
+
+void bench_update_animat(Bench_Context *ctx, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; ++i) {
+    update_animat(&ctx->animats[i & (BENCH_ANIMATS_COUNT - 1)], BENCH_TICK_DT);
+  }
+  bench_sink = bench_sink + (int64_t)ctx->animats[0].frame_current;
+}
+
+void bench_vec2i_add(Bench_Context *ctx, uint64_t ops) {
+  Vec2i sum = {};
+  for (uint64_t i = 0; i < ops; ++i) {
+    sum = sum + ctx->vectors_i[i & (BENCH_VECTORS_COUNT - 1)];
+  }
+  bench_sink = bench_sink + sum.x + sum.y;
+}
+
+void bench_vec2i_scale(Bench_Context *ctx, uint64_t ops) {
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; ++i) {
+    const Vec2i v = ctx->vectors_i[i & (BENCH_VECTORS_COUNT - 1)] * 3;
+    sum += v.x + v.y;
+  }
+  bench_sink = bench_sink + sum;
+}
+
+void bench_vec2x_add(Bench_Context *ctx, uint64_t ops) {
+  Vec2x sum = {};
+  for (uint64_t i = 0; i < ops; ++i) {
+    sum += ctx->velocities_x[i & (BENCH_VECTORS_COUNT - 1)];
+  }
+  bench_sink = bench_sink + sum.x.raw + sum.y.raw;
+}
+
+void bench_vec2_floor(Bench_Context *ctx, uint64_t ops) {
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; ++i) {
+    const Vec2i v = vec2_floor(ctx->vectors_x[i & (BENCH_VECTORS_COUNT - 1)]);
+    sum += v.x + v.y;
+  }
+  bench_sink = bench_sink + sum;
+}
+
+void bench_get_sqr_dist(Bench_Context *ctx, uint64_t ops) {
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; ++i) {
+    sum += get_sqr_dist(ctx->vectors_i[i & (BENCH_VECTORS_COUNT - 1)],
+                        ctx->vectors_i[(i + 1) & (BENCH_VECTORS_COUNT - 1)]);
+  }
+  bench_sink = bench_sink + sum;
+}
+
+// * One op is one vector of the batch
+void bench_vec2x_add_batch(Bench_Context *ctx, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i += ctx->vectors_count) {
+    vec2_add_batch(ctx->vectors_x, ctx->velocities_x, ctx->vectors_count);
+  }
+  bench_sink = bench_sink + ctx->vectors_x[0].x.raw;
+}
+
+// * Scales by -1, so the vectors stay the same over the rounds
+void bench_vec2i_scale_batch(Bench_Context *ctx, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i += ctx->vectors_count) {
+    vec2_scale_batch(ctx->vectors_i, -1, ctx->vectors_count);
+  }
+  bench_sink = bench_sink + ctx->vectors_i[0].x;
+}
+
+void bench_vec2x_scale_batch(Bench_Context *ctx, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i += ctx->vectors_count) {
+    vec2_scale_batch(ctx->velocities_x, fixed(-1), ctx->vectors_count);
+  }
+  bench_sink = bench_sink + ctx->velocities_x[0].x.raw;
+}
+
+void bench_vec2_floor_div_batch(Bench_Context *ctx, uint64_t ops) {
+  Vec2i tiles[BENCH_VECTORS_COUNT];
+  int64_t sum = 0;
+  for (uint64_t i = 0; i < ops; i += ctx->vectors_count) {
+    vec2_floor_div_batch<TILE_SIZE>(tiles, ctx->vectors_i, ctx->vectors_count);
+    sum += tiles[0].x;
+  }
+  bench_sink = bench_sink + sum;
+}
+
+// * One op is one frame of the game without the rendering: bot input,
+// * scripts, simulation and impact particles. None of it may touch the
+// * heap, the benchmark aborts when it does.
+void bench_frame(Bench_Context *ctx, uint64_t ops) {
+  const size_t heap_allocs = bench_heap_allocs_count;
+  for (uint64_t i = 0; i < ops; ++i) {
+    Tick_Input input = bot_input(&ctx->world, &ctx->bot);
+    scheduler_tick(&ctx->scheduler, &ctx->world, &input);
+    apply_tick_input(&ctx->world, &input);
+    world_step(&ctx->world, BENCH_TICK_DT);
+
+    for (size_t j = 0; j < ctx->world.projectiles.impacts_count; ++j) {
+      spawn_impact_effect(&ctx->particles, ctx->world.projectiles.impacts[j]);
+    }
+    update_particles(&ctx->particles, BENCH_TICK_DT);
+  }
+  bench_sink = bench_sink + (int64_t)ctx->particles.count;
+
+  if (bench_heap_allocs_count != heap_allocs) {
+    fprintf(stderr, "ERROR: %zu heap allocations in %llu frames\n",
+            bench_heap_allocs_count - heap_allocs, (unsigned long long)ops);
+    abort();
+  }
+}
+
+struct Bench {
+  const char *name;
+  Bench_Fn fn;
+  bool uses_map; // * run for every map size & density
+};
+
+const Bench benches[] = {
+  {"resolve_point_collision", bench_resolve_point_collision, true},
+  {"resolve_entity_collision", bench_resolve_entity_collision, true},
+  {"update_projectiles", bench_update_projectiles, true},
+  {"update_animat", bench_update_animat, false},
+  {"vec2i_add", bench_vec2i_add, false},
+  {"vec2i_scale", bench_vec2i_scale, false},
+  {"vec2x_add", bench_vec2x_add, false},
+  {"vec2_floor", bench_vec2_floor, false},
+  {"get_sqr_dist", bench_get_sqr_dist, false},
+  {"vec2x_add_batch", bench_vec2x_add_batch, false},
+  {"vec2i_scale_batch", bench_vec2i_scale_batch, false},
+  {"vec2x_scale_batch", bench_vec2x_scale_batch, false},
+  {"vec2_floor_div_batch", bench_vec2_floor_div_batch, false},
+  {"frame", bench_frame, false},
+};
+
+// * ####################
+// * Runner
+// * ####################
+
+struct Bench_Result {
+  const char *name;
+  int map_size; // * 0 when the benchmark does not use a map
+  int density;
+  uint64_t ops;
+  double ns_per_op;
+  double heap_allocs_per_op;
+  double arena_allocs_per_op;
+};
+
+// * Doubles the number of ops until a run takes at least `min_time_ns`, the
+// * last run is the one reported
+Bench_Result run_bench(const Bench *bench, Bench_Context *ctx, double min_time_ns) {
+  // * Warm up the caches & branch predictors
+  bench->fn(ctx, BENCH_SAMPLES_COUNT);
+
+  uint64_t ops = BENCH_SAMPLES_COUNT;
+  for (;;) {
+    const size_t heap_allocs = bench_heap_allocs_count;
+    const size_t arena_allocs = get_arena_allocs_count();
+    ctx->untimed_ns = 0.0;
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    bench->fn(ctx, ops);
+    const double elapsed = get_elapsed_ns(begin) - ctx->untimed_ns;
+
+    if (elapsed >= min_time_ns || ops >= (1ull << 40)) {
+      return {
+        .name = bench->name,
+        .map_size = bench->uses_map ? ctx->map_size : 0,
+        .density = bench->uses_map ? ctx->density : 0,
+        .ops = ops,
+        .ns_per_op = elapsed / (double)ops,
+        .heap_allocs_per_op = (double)(bench_heap_allocs_count - heap_allocs) / (double)ops,
+        .arena_allocs_per_op = (double)(get_arena_allocs_count() - arena_allocs) / (double)ops,
+      };
+    }
+    ops *= 2;
+  }
+}
+
+enum class Bench_Format {
+  Text,
+  Csv,
+  Json
+};
+
+void print_bench_header(Bench_Format format) {
+  switch (format) {
+    case Bench_Format::Text: {
+      printf("%-26s %5s %8s %12s %10s %12s %12s\n",
+             "benchmark", "map", "density", "ops", "ns/op", "heap/op", "arena/op");
+    } break;
+    case Bench_Format::Csv: {
+      printf("benchmark,map_size,density,ops,ns_per_op,heap_allocs_per_op,arena_allocs_per_op\n");
+    } break;
+    case Bench_Format::Json: {
+      printf("[\n");
+    } break;
+  }
+}
+
+void print_bench_result(Bench_Format format, const Bench_Result *r, bool first) {
+  switch (format) {
+    case Bench_Format::Text: {
+      printf("%-26s %5d %7d%% %12llu %10.2f %12.4f %12.4f\n",
+             r->name, r->map_size, r->density, (unsigned long long)r->ops,
+             r->ns_per_op, r->heap_allocs_per_op, r->arena_allocs_per_op);
+    } break;
+    case Bench_Format::Csv: {
+      printf("%s,%d,%d,%llu,%.3f,%.6f,%.6f\n",
+             r->name, r->map_size, r->density, (unsigned long long)r->ops,
+             r->ns_per_op, r->heap_allocs_per_op, r->arena_allocs_per_op);
+    } break;
+    case Bench_Format::Json: {
+      printf("%s  {\"benchmark\": \"%s\", \"map_size\": %d, \"density\": %d, \"ops\": %llu, "
+             "\"ns_per_op\": %.3f, \"heap_allocs_per_op\": %.6f, \"arena_allocs_per_op\": %.6f}",
+             first ? "" : ",\n",
+             r->name, r->map_size, r->density, (unsigned long long)r->ops,
+             r->ns_per_op, r->heap_allocs_per_op, r->arena_allocs_per_op);
+    } break;
+  }
+}
+
+void print_bench_footer(Bench_Format format) {
+  if (format == Bench_Format::Json) {
+    printf("\n]\n");
+  }
+}
+
+void usage(const char *program) {
+  fprintf(stderr, "Usage: %s [--format text|csv|json] [--filter <substring>] [--min-time <ms>] [--seed <n>]\n", program);
+}
+
+int main(int argc, char **argv) {
+  Bench_Format format = Bench_Format::Text;
+  const char *filter = nullptr;
+  double min_time_ms = 200.0;
+  uint32_t seed = 0x1337;
+
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    const char *flag = argv[i];
+    const char *value = argv[++i];
+    if (strcmp(flag, "--format") == 0) {
+      if (strcmp(value, "text") == 0) format = Bench_Format::Text;
+      else if (strcmp(value, "csv") == 0) format = Bench_Format::Csv;
+      else if (strcmp(value, "json") == 0) format = Bench_Format::Json;
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(flag, "--filter") == 0) {
+      filter = value;
+    } else if (strcmp(flag, "--min-time") == 0) {
+      min_time_ms = strtod(value, nullptr);
+    } else if (strcmp(flag, "--seed") == 0) {
+      seed = (uint32_t)strtoul(value, nullptr, 10);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // * Too big for the stack
+  static Bench_Context ctx = {};
+  ctx.rng = seed ? seed : 0x9e3779b9;
+  generate_bench_data(&ctx);
+  init_bench_frame(&ctx);
+
+  const double min_time_ns = min_time_ms * 1e6;
+  bool first = true;
+  print_bench_header(format);
+  for (const Bench &bench : benches) {
+    if (filter && !strstr(bench.name, filter)) continue;
+
+    if (!bench.uses_map) {
+      const Bench_Result result = run_bench(&bench, &ctx, min_time_ns);
+      print_bench_result(format, &result, first);
+      first = false;
+      continue;
+    }
+
+    for (int map_size : BENCH_MAP_SIZES) {
+      for (int density : BENCH_DENSITIES) {
+        generate_bench_map(&ctx, map_size, density);
+        init_bench_projectiles(&ctx);
+
+        const Bench_Result result = run_bench(&bench, &ctx, min_time_ns);
+        print_bench_result(format, &result, first);
+        first = false;
+      }
+    }
+  }
+  print_bench_footer(format);
+  return 0;
+}
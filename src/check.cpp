@@ -0,0 +1,129 @@
+// * ##################################
+// * Headless Checks
+// * ##################################
+
+// * Plays scripted scenarios on headless worlds and fails when the
+// * simulation does not do what it should. Same single compilation unit as
+// * the game without main.cpp, no window or renderer is created.
+// *
+// * $ checks [--filter <substring>]
+
+#define SCU_NO_MAIN
+#include "scu.cpp"
+
+const Uint64 CHECK_TICK_DT = 16;
+
+// * ####################
+// * Chase
+// * ####################
+
+// * Walking a tile takes 64 ticks at the enemy speed, the longest path of
+// * the level is well under a hundred moves
+const size_t CHASE_TICKS = 3000;
+
+// * The enemy gets to the player standing on `tile` within CHASE_TICKS
+bool check_chase_to(const World_Assets *assets, Vec2i tile) {
+  static World world;
+  init_world(&world, assets);
+  Entity *player = get_player(&world);
+  player->spawn = get_tile_centre(tile);
+  respawn_entity(player);
+
+  for (size_t tick = 0; tick < CHASE_TICKS; ++tick) {
+    const Tick_Input input = {};
+    apply_tick_input(&world, &input);
+    world_step(&world, CHECK_TICK_DT);
+
+    const Vec2i enemy = world_to_tile(vec2_floor(world.entities[PLAYER_ENTITY + 1].pos));
+    const Vec2i target = get_player_tile(&world);
+    if (enemy.x == target.x && enemy.y == target.y) return true;
+  }
+  return false;
+}
+
+// * Every tile the enemy has a path to from its spawn
+bool check_chase(const World_Assets *assets) {
+  bool ok = true;
+  static World world;
+  init_world(&world, assets);
+  const Vec2i enemy = world_to_tile(vec2_floor(world.entities[PLAYER_ENTITY + 1].pos));
+
+  for (int y = 0; y < LEVEL_HEIGHT; ++y) {
+    for (int x = 0; x < LEVEL_WIDTH; ++x) {
+      const Vec2i tile = vec2(x, y);
+      if (!is_tile_standable(&world.level, tile)) continue;
+
+      compute_flow_field(&world.flow_field, &world.level, tile);
+      if (get_flow_distance(&world.flow_field, enemy) == FLOW_FIELD_UNREACHABLE) continue;
+
+      if (!check_chase_to(assets, tile)) {
+        fprintf(stderr, "  enemy never reached the player at tile (%d, %d)\n", x, y);
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+// * ####################
+// * Bots
+// * ####################
+
+const size_t BOTS_WORLDS_COUNT = 64;
+const size_t BOTS_TICKS = 5000;
+
+// * Random bots never walk their player out of the level
+bool check_bots(const World_Assets *assets) {
+  static World worlds[BOTS_WORLDS_COUNT];
+  Bot bots[BOTS_WORLDS_COUNT];
+  for (size_t i = 0; i < BOTS_WORLDS_COUNT; ++i) {
+    init_world(&worlds[i], assets);
+    bots[i] = make_bot((uint32_t)(i + 1));
+  }
+  run_world_batch(worlds, bots, BOTS_WORLDS_COUNT, BOTS_TICKS, CHECK_TICK_DT);
+
+  bool ok = true;
+  for (size_t i = 0; i < BOTS_WORLDS_COUNT; ++i) {
+    if (worlds[i].player_falls_count > 0) {
+      fprintf(stderr, "  bot %zu lost its player %zu times\n", i, worlds[i].player_falls_count);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// * ####################
+// * Runner
+// * ####################
+
+typedef bool (*Check_Fn)(const World_Assets *assets);
+
+struct Check {
+  const char *name;
+  Check_Fn fn;
+};
+
+const Check checks[] = {
+  {"chase", check_chase},
+  {"bots", check_bots},
+};
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  if (argc == 3 && strcmp(argv[1], "--filter") == 0) {
+    filter = argv[2];
+  } else if (argc != 1) {
+    fprintf(stderr, "Usage: %s [--filter <substring>]\n", argv[0]);
+    return 1;
+  }
+
+  const World_Assets assets = headless_world_assets();
+  size_t failed_count = 0;
+  for (const Check &check : checks) {
+    if (filter && !strstr(check.name, filter)) continue;
+    const bool ok = check.fn(&assets);
+    printf("%-24s %s\n", check.name, ok ? "ok" : "FAILED");
+    failed_count += !ok;
+  }
+  return failed_count == 0 ? 0 : 1;
+}
@@ -8,29 +8,46 @@ enum class Entity_State {
   Alive
 };
 
+// * Which of the entity animats is playing. An index rather than a pointer
+// * into the entity itself, so entities can be copied around freely.
+enum class Entity_Animat {
+  Idle = 0,
+  Walking
+};
+
 struct Entity {
 
   SDL_Rect texbox;
   SDL_Rect hitbox;
-  Vec2i pos;
-  Vec2i vel;
+  Vec2x pos; // * sub-pixel position
+  Vec2x vel; // * sub-pixel velocity
 
   Animat idle;
   Animat walking;
-  Animat *current;
+  Entity_Animat current;
 
   Entity_Dir dir;
 
-  int weapon_cooldown;
+  int weapon_cooldown; // * ticks until the entity can shoot again
+
+  Vec2i spawn; // * where the entity comes back after falling out of the level
+
+  // * Driven by a behaviour script instead of the built-in enemy AI
+  bool scripted;
 };
 
 
-const int entity_count = 69;
-Entity entities[entity_count];
+const size_t entity_count = 69;
+
+static inline
+const Animat *get_entity_animat(const Entity *entity) {
+  return entity->current == Entity_Animat::Walking ? &entity->walking : &entity->idle;
+}
 
 SDL_Rect get_entity_dstrect(const Entity entity) {
+  const Vec2i pos = vec2_floor(entity.pos);
   SDL_Rect dstrect = {
-      entity.texbox.x + entity.pos.x, entity.texbox.y + entity.pos.y,
+      entity.texbox.x + pos.x, entity.texbox.y + pos.y,
       entity.texbox.w, entity.texbox.h};
   return dstrect;
 }
@@ -38,22 +55,22 @@ SDL_Rect get_entity_dstrect(const Entity entity) {
 void render_entity(SDL_Renderer *renderer, const Entity entity) {
   const SDL_Rect entity_dstrect = get_entity_dstrect(entity);
   const SDL_RendererFlip flip = entity.dir == Entity_Dir::Right ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
-  render_animat(renderer, *entity.current, entity_dstrect, flip);
+  render_animat(renderer, *get_entity_animat(&entity), entity_dstrect, flip);
 }
 
-void resolve_point_collision(Vec2i *p) {
+void resolve_point_collision(const Level *level, Vec2i *p) {
   assert(p);
 
-  const Vec2i tile = *p / TILE_SIZE;
+  const Vec2i tile = world_to_tile(*p);
   // printf("tile_x: %d, tile_y: %d\n", tile.x, tile.y);
 
   // * check if player out of bound or standing on empty tile
-  if(is_tile_empty(tile)) {
+  if(is_tile_empty(level, tile)) {
     return;
   }
 
-  const Vec2i p0 = tile * TILE_SIZE;
-  const Vec2i p1 = (tile + 1) * TILE_SIZE;
+  const Vec2i p0 = tile_to_world(tile);
+  const Vec2i p1 = tile_to_world(tile + 1);
 
   struct Side {
     int sqr_distance;
@@ -66,11 +83,15 @@ void resolve_point_collision(Vec2i *p) {
 
   const size_t TILE_SIZE_SQR = TILE_SIZE * TILE_SIZE;
 
+  // * Ties go to the first side: top & bottom come first, so a point as deep
+  // * into the top of a ledge as into its side lands on it. Otherwise
+  // * walking onto a ledge at 1 px per tick while gravity pulls 1 px down
+  // * gets pushed back off every tick.
   Side sides[] = {
-      {get_sqr_dist({p0.x, 0}, {p->x, 0}), {p0.x, p->y}, {-1, 0}, TILE_SIZE_SQR},            // * Left side
-      {get_sqr_dist({p1.x, 0}, {p->x, 0}), {p1.x, p->y}, {1, 0}, TILE_SIZE_SQR},             // * Right side
       {get_sqr_dist({0, p0.y}, {0, p->y}), {p->x, p0.y}, {0, -1}, TILE_SIZE_SQR},            // * Top side
       {get_sqr_dist({0, p1.y}, {0, p->y}), {p->x, p1.y}, {0, 1}, TILE_SIZE_SQR},             // * Bottom side
+      {get_sqr_dist({p0.x, 0}, {p->x, 0}), {p0.x, p->y}, {-1, 0}, TILE_SIZE_SQR},            // * Left side
+      {get_sqr_dist({p1.x, 0}, {p->x, 0}), {p1.x, p->y}, {1, 0}, TILE_SIZE_SQR},             // * Right side
       {get_sqr_dist({p0.x, p0.y}, {p->x, p->y}), {p0.x, p0.y}, {-1, -1}, TILE_SIZE_SQR * 2}, // * Top left
       {get_sqr_dist({p1.x, p0.y}, {p->x, p->y}), {p1.x, p0.y}, {1, -1}, TILE_SIZE_SQR * 2},  // * Top right
       {get_sqr_dist({p0.x, p1.y}, {p->x, p->y}), {p0.x, p1.y}, {-1, 1}, TILE_SIZE_SQR * 2},  // * Bottom left
@@ -92,7 +113,7 @@ void resolve_point_collision(Vec2i *p) {
 
     // * Check for neighbouring tiles
     // * If neighbouring tile is wall, increase the sqr_distance by TILE_SIZE
-    for (int i = 1; !is_tile_empty(tile + sides[current_side].nd * i); ++i)
+    for (int i = 1; !is_tile_empty(level, tile + sides[current_side].nd * i); ++i)
     {
       sides[current_side].sqr_distance += sides[current_side].dd;
     }
@@ -105,10 +126,11 @@ void resolve_point_collision(Vec2i *p) {
   *p = sides[closest_side].np;
 }
 
-void resolve_entity_collision(Entity *entity) {
+void resolve_entity_collision(const Level *level, Entity *entity) {
   assert(entity);
 
-  Vec2i p0 = vec2(entity->hitbox.x, entity->hitbox.y) + entity->pos;
+  // * Collision is resolved on whole pixels, the sub-pixel part of the position is kept
+  Vec2i p0 = vec2(entity->hitbox.x, entity->hitbox.y) + vec2_floor(entity->pos);
   Vec2i p1 = p0 + vec2(entity->hitbox.w, entity->hitbox.h);
 
   Vec2i mesh[] = {
@@ -123,34 +145,71 @@ void resolve_entity_collision(Entity *entity) {
   for (int i = 0; i < MESH_COUNT; ++i) {
     Vec2i t = mesh[i];
 
-    resolve_point_collision(&t);
+    resolve_point_collision(level, &t);
     Vec2i d = t - mesh[i]; 
 
     // printf("dx: %d, dy: %d\n", d.x, d.y);
     if (std::abs(d.y) >= IMPACT_THRESHOLD) {
-      entity->vel.y = 0;
+      entity->vel.y = fixed(0);
     }
 
     if (std::abs(d.x) >= IMPACT_THRESHOLD) {
-      entity->vel.x = 0;
+      entity->vel.x = fixed(0);
     }
 
     for(int j = 0;  j < MESH_COUNT; ++j) {
       mesh[j] += d;
     }
-    entity->pos += d;
+    entity->pos += vec2_fixed(d);
   }
 }
 
-void update_entity(Entity *entity, Vec2i gravity, Uint64 dt) {
+// * Whether a solid tile is right under the hitbox. The velocity can not
+// * tell: it is 0 at the top of a jump and only zeroed by big impacts.
+bool is_entity_on_ground(const Level *level, const Entity *entity) {
+  assert(entity);
+  const Vec2i p0 = vec2(entity->hitbox.x, entity->hitbox.y) + vec2_floor(entity->pos);
+  const Vec2i p1 = p0 + vec2(entity->hitbox.w, entity->hitbox.h);
+  // * Collision leaves a standing entity with its bottom on the top row of
+  // * the floor. A corner against a wall face has solid tiles above as well.
+  for (int x : {p0.x, p1.x}) {
+    if (!is_tile_empty(level, world_to_tile(vec2(x, p1.y + 1))) &&
+        is_tile_empty(level, world_to_tile(vec2(x, p1.y - 1)))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// * Whether there is floor under the pixel just past the bottom corner of
+// * the hitbox on the `dir` side, i.e. one more step that way is no ledge
+bool is_ground_ahead(const Level *level, const Entity *entity, Entity_Dir dir) {
+  assert(entity);
+  const Vec2i p0 = vec2(entity->hitbox.x, entity->hitbox.y) + vec2_floor(entity->pos);
+  const Vec2i p1 = p0 + vec2(entity->hitbox.w, entity->hitbox.h);
+  const int x = dir == Entity_Dir::Right ? p1.x + 1 : p0.x - 1;
+  return !is_tile_empty(level, world_to_tile(vec2(x, p1.y + 1)));
+}
+
+// * Under half a tile per tick, so a falling entity can not tunnel through
+// * a floor. Also keeps the position of anything falling far from the range
+// * of Fixed until it gets respawned.
+const int ENTITY_TERMINAL_VELOCITY = 24;
+
+void update_entity(const Level *level, Entity *entity, Vec2x gravity, Uint64 dt) {
   // * Add gravity to player velocity
   entity->vel += gravity;
+  entity->vel.y = std::min(entity->vel.y, fixed(ENTITY_TERMINAL_VELOCITY));
   entity->pos += entity->vel;
 
   // * Resolve entity collision
-  resolve_entity_collision(entity);
+  resolve_entity_collision(level, entity);
 
   update_animat(&entity->walking, dt);
+
+  if (entity->weapon_cooldown > 0) {
+    entity->weapon_cooldown -= 1;
+  }
 }
 
 // * Creates a SDL_Texture from text
@@ -160,13 +219,14 @@ SDL_Texture *render_text_as_texture(TTF_Font *font,
                                     SDL_Color color) {
   SDL_Surface *text_surface = stec(TTF_RenderText_Blended(font, text, color));
   SDL_Texture *text_texture = sec(SDL_CreateTextureFromSurface(renderer, text_surface));
+  record_texture_created(text_texture);
   SDL_FreeSurface(text_surface);
   return text_texture;
 }
 
 void entity_move(Entity *entity, int speed) {
   assert(entity);
-  entity->vel.x = speed;
+  entity->vel.x = fixed(speed);
 
   // * Move entity in right direction
   if(speed > 0) {
@@ -176,28 +236,103 @@ void entity_move(Entity *entity, int speed) {
     entity->dir = Entity_Dir::Left;
   }
 
-  entity->current = &entity->walking;
+  entity->current = Entity_Animat::Walking;
+}
+
+// * Below the level nothing is solid, whatever gets there would fall forever
+bool has_entity_fallen_out(const Entity *entity) {
+  assert(entity);
+  return vec2_floor(entity->pos).y + entity->hitbox.y >= level_boundary.y + level_boundary.h;
+}
+
+void respawn_entity(Entity *entity) {
+  assert(entity);
+  entity->pos = vec2_fixed(entity->spawn);
+  entity->vel = vec2(fixed(0), fixed(0));
 }
 
 void entity_stop(Entity *entity) {
   assert(entity);
-  entity->vel.x = 0;
-  entity->current = &entity->idle;
+  entity->vel.x = fixed(0);
+  entity->current = Entity_Animat::Idle;
+}
+
+const int ENTITY_JUMP_SPEED = 20;
+
+void entity_jump(Entity *entity) {
+  assert(entity);
+  entity->vel.y = fixed(-ENTITY_JUMP_SPEED);
+}
+
+// * Steers the entity with the move the flow field stores for its tile
+void entity_follow_flow_field(const Level *level, Entity *entity, const Flow_Field *field, int speed) {
+  assert(entity);
+
+  Vec2i tile = world_to_tile(vec2_floor(entity->pos));
+  // * Only jump off the ground
+  const bool grounded = is_entity_on_ground(level, entity);
+
+  // * The tile is looked up by the centre of the entity, while the hitbox
+  // * can rest on the ledge of the next column. Steer from the ledge when it
+  // * is closer to the target, e.g. right after jumping onto it.
+  if (grounded && !is_tile_standable(level, tile)) {
+    const Vec2i p0 = vec2(entity->hitbox.x, entity->hitbox.y) + vec2_floor(entity->pos);
+    const Vec2i p1 = p0 + vec2(entity->hitbox.w, entity->hitbox.h);
+    const int ledge_x = is_tile_empty(level, world_to_tile(vec2(p0.x, p1.y + 1))) ? p1.x : p0.x;
+    const Vec2i ledge = world_to_tile(vec2(ledge_x, p1.y));
+    if (get_flow_distance(field, ledge) < get_flow_distance(field, tile)) tile = ledge;
+  }
+
+  switch (get_flow_move(field, tile)) {
+    case Flow_Move::Left: {
+      entity_move(entity, -speed);
+    } break;
+    case Flow_Move::Right: {
+      entity_move(entity, speed);
+    } break;
+    case Flow_Move::Jump: {
+      entity_stop(entity);
+      if (grounded) entity_jump(entity);
+    } break;
+    case Flow_Move::Jump_Left: {
+      entity_move(entity, -speed);
+      if (grounded) entity_jump(entity);
+    } break;
+    case Flow_Move::Jump_Right: {
+      entity_move(entity, speed);
+      if (grounded) entity_jump(entity);
+    } break;
+    case Flow_Move::Fall: {
+      // * Still on the ledge it came from: step toward the middle of the
+      // * tile (the tile below it is empty) until it drops
+      if (grounded) {
+        const int centre = vec2_floor(entity->pos).x + entity->hitbox.x + entity->hitbox.w / 2;
+        const int tile_centre = tile_to_world(tile).x + TILE_SIZE / 2;
+        entity_move(entity, centre < tile_centre ? speed : -speed);
+      }
+      // * In the air keep the momentum, a jump toward a ledge rises
+      // * through falling tiles
+    } break;
+    case Flow_Move::None:
+    default: {
+      if (grounded) entity_stop(entity);
+    } break;
+  }
 }
 
 const int ENTITY_WEAPON_COOLDOWN = 30;
 
 // * shoots the projectile
-void entity_shoot(Entity *entity) {
+void entity_shoot(Entity *entity, Projectile_Pool *pool) {
   assert(entity);
 
   if (entity->weapon_cooldown > 0)
     return;
 
   if (entity->dir == Entity_Dir::Right) {
-    spwan_projectile(entity->pos, vec2(4, 0));
+    spwan_projectile(pool, vec2_floor(entity->pos), vec2(4, 0));
   } else {
-    spwan_projectile(entity->pos, vec2(-4, 0));
+    spwan_projectile(pool, vec2_floor(entity->pos), vec2(-4, 0));
   }
 
   entity->weapon_cooldown = ENTITY_WEAPON_COOLDOWN;
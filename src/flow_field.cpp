@@ -0,0 +1,168 @@
+// * ####################
+// * Flow Field
+// * ####################
+
+// * Distance map toward a target tile over the walkable (empty) tiles, with
+// * platformer moves: walking needs ground below, jumping goes up to
+// * FLOW_FIELD_JUMP_HEIGHT tiles, falling is one way. Every agent steers by
+// * looking up the move stored for its tile, no per agent search.
+
+enum class Flow_Move : uint8_t {
+  None = 0, // * at the target or the target is unreachable
+  Left,
+  Right,
+  Jump,
+  Jump_Left,
+  Jump_Right,
+  Fall
+};
+
+const int FLOW_FIELD_JUMP_HEIGHT = 3;
+const uint16_t FLOW_FIELD_UNREACHABLE = UINT16_MAX;
+
+struct Flow_Field {
+  Vec2i target;
+  bool dirty; // * level changed since the last compute
+  uint16_t distance[LEVEL_HEIGHT][LEVEL_WIDTH];
+  Flow_Move moves[LEVEL_HEIGHT][LEVEL_WIDTH];
+};
+
+static inline
+bool is_tile_standable(const Level *level, Vec2i tile) {
+  return is_tile_inbounds(tile) && is_tile_empty(level, tile) && !is_tile_empty(level, tile + vec2(0, 1));
+}
+
+// * Can an agent standing on `from` jump `dx` tiles sideways and `height` tiles up
+static inline
+bool can_jump(const Level *level, Vec2i from, int dx, int height) {
+  if (!is_tile_standable(level, from)) return false;
+  for (int k = 1; k <= height; ++k) {
+    if (!is_tile_empty(level, from - vec2(0, k))) return false;
+  }
+  const Vec2i to = from + vec2(dx, -height);
+  return is_tile_inbounds(to) && is_tile_empty(level, to);
+}
+
+// * Calls `visit(to, move)` for every move out of `from`
+template <typename Visit>
+void for_each_flow_move(const Level *level, Vec2i from, Visit visit) {
+  if (is_tile_standable(level, from)) {
+    for (int dx = -1; dx <= 1; dx += 2) {
+      const Vec2i to = from + vec2(dx, 0);
+      if (is_tile_inbounds(to) && is_tile_empty(level, to)) {
+        visit(to, dx < 0 ? Flow_Move::Left : Flow_Move::Right);
+      }
+    }
+    for (int height = 1; height <= FLOW_FIELD_JUMP_HEIGHT; ++height) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        if (can_jump(level, from, dx, height)) {
+          visit(from + vec2(dx, -height),
+                dx < 0 ? Flow_Move::Jump_Left : dx > 0 ? Flow_Move::Jump_Right : Flow_Move::Jump);
+        }
+      }
+    }
+  } else {
+    const Vec2i to = from + vec2(0, 1);
+    if (is_tile_inbounds(to) && is_tile_empty(level, to)) {
+      visit(to, Flow_Move::Fall);
+    }
+  }
+}
+
+// * Calls `visit(from)` for every tile that has a move into `to`
+// * (the reverse of for_each_flow_move)
+template <typename Visit>
+void for_each_flow_predecessor(const Level *level, Vec2i to, Visit visit) {
+  // * Walked in from the side
+  for (int dx = -1; dx <= 1; dx += 2) {
+    const Vec2i from = to + vec2(dx, 0);
+    if (is_tile_standable(level, from)) visit(from);
+  }
+
+  // * Fell in from above
+  const Vec2i above = to - vec2(0, 1);
+  if (is_tile_inbounds(above) && is_tile_empty(level, above) && !is_tile_standable(level, above)) {
+    visit(above);
+  }
+
+  // * Jumped in from below
+  for (int height = 1; height <= FLOW_FIELD_JUMP_HEIGHT; ++height) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      const Vec2i from = to - vec2(dx, -height);
+      if (can_jump(level, from, dx, height)) visit(from);
+    }
+  }
+}
+
+void compute_flow_field(Flow_Field *field, const Level *level, Vec2i target) {
+  assert(field);
+  assert(level);
+
+  field->target = target;
+  field->dirty = false;
+  for (int y = 0; y < LEVEL_HEIGHT; ++y) {
+    for (int x = 0; x < LEVEL_WIDTH; ++x) {
+      field->distance[y][x] = FLOW_FIELD_UNREACHABLE;
+      field->moves[y][x] = Flow_Move::None;
+    }
+  }
+
+  if (!is_tile_inbounds(target) || !is_tile_empty(level, target)) {
+    return;
+  }
+
+  // * Breadth first search backwards from the target
+  Vec2i queue[LEVEL_WIDTH * LEVEL_HEIGHT];
+  size_t queue_begin = 0, queue_end = 0;
+
+  field->distance[target.y][target.x] = 0;
+  queue[queue_end++] = target;
+
+  while (queue_begin < queue_end) {
+    const Vec2i to = queue[queue_begin++];
+    const uint16_t d = (uint16_t)(field->distance[to.y][to.x] + 1);
+
+    for_each_flow_predecessor(level, to, [&](Vec2i from) {
+      if (field->distance[from.y][from.x] == FLOW_FIELD_UNREACHABLE) {
+        field->distance[from.y][from.x] = d;
+        queue[queue_end++] = from;
+      }
+    });
+  }
+
+  // * Bake the best move of every tile so steering is a single lookup
+  for (int y = 0; y < LEVEL_HEIGHT; ++y) {
+    for (int x = 0; x < LEVEL_WIDTH; ++x) {
+      const Vec2i from = vec2(x, y);
+      uint16_t best = field->distance[y][x];
+      if (best == FLOW_FIELD_UNREACHABLE) continue;
+
+      for_each_flow_move(level, from, [&](Vec2i to, Flow_Move move) {
+        if (field->distance[to.y][to.x] < best) {
+          best = field->distance[to.y][to.x];
+          field->moves[y][x] = move;
+        }
+      });
+    }
+  }
+}
+
+// * Recomputes only when the target moved to another tile or the level changed
+void update_flow_field(Flow_Field *field, const Level *level, Vec2i target) {
+  assert(field);
+  if (field->dirty || field->target.x != target.x || field->target.y != target.y) {
+    compute_flow_field(field, level, target);
+  }
+}
+
+Flow_Move get_flow_move(const Flow_Field *field, Vec2i tile) {
+  assert(field);
+  if (!is_tile_inbounds(tile)) return Flow_Move::None;
+  return field->moves[tile.y][tile.x];
+}
+
+uint16_t get_flow_distance(const Flow_Field *field, Vec2i tile) {
+  assert(field);
+  if (!is_tile_inbounds(tile)) return FLOW_FIELD_UNREACHABLE;
+  return field->distance[tile.y][tile.x];
+}
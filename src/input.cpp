@@ -0,0 +1,165 @@
+// * ####################
+// * Input
+// * ####################
+
+// * Drains the SDL events of a frame into one record. Every event only
+// * updates a few fields: mouse motion keeps the latest position, key
+// * presses set actions and a drag only stores the tile spans it crossed.
+// * The expensive work (collision probe, tile edits) runs once per tick on
+// * the record, whatever the event rate.
+
+enum class Action : uint8_t {
+  Jump = 0,
+  Shoot,
+  Respawn,
+  Quit,
+  Toggle_Debug,
+  Toggle_Rollback_Test,
+  Quick_Save,
+  Quick_Load,
+  Count
+};
+
+struct Action_Binding {
+  SDL_Keycode key;
+  Action action;
+};
+
+const Action_Binding action_bindings[] = {
+  {SDLK_SPACE, Action::Jump},
+  {SDLK_e, Action::Shoot},
+  {SDLK_r, Action::Respawn},
+  {SDLK_l, Action::Quit},
+  {SDLK_q, Action::Toggle_Debug},
+  {SDLK_F2, Action::Toggle_Rollback_Test},
+  {SDLK_F5, Action::Quick_Save},
+  {SDLK_F9, Action::Quick_Load},
+};
+
+// * Tiles crossed by the mouse between two motion events, inclusive
+struct Paint_Span {
+  Vec2i from;
+  Vec2i to;
+};
+
+const size_t INPUT_PAINT_SPANS_CAPACITY = 16;
+
+struct Input_Record {
+  // * Reset every tick
+  bool pressed[(size_t)Action::Count];
+  int move; // * < 0 left, > 0 right, 0 stop
+  bool mouse_moved;
+  bool paint_begin; // * the button went down this tick, on spans[0].from
+  Paint_Span spans[INPUT_PAINT_SPANS_CAPACITY];
+  size_t spans_count;
+
+  // * Kept across ticks
+  Vec2i mouse;      // * internal resolution coordinates
+  bool painting;    // * mouse button held
+  Vec2i paint_tile; // * last tile added to the spans
+};
+
+static inline
+bool is_action_pressed(const Input_Record *record, Action action) {
+  return record->pressed[(size_t)action];
+}
+
+static inline
+void push_paint_span(Input_Record *record, Vec2i from, Vec2i to) {
+  if (record->spans_count < INPUT_PAINT_SPANS_CAPACITY) {
+    record->spans[record->spans_count++] = {from, to};
+  } else {
+    // * Out of room, stretch the last span instead. Skips some tiles of a
+    // * very fast scribble but keeps the cost bounded.
+    record->spans[record->spans_count - 1].to = to;
+  }
+}
+
+// * Replaces the per-tick part of the record with the events since the last call
+void poll_input(Input_Record *record, const Render_Target *target) {
+  assert(record);
+  memset(record->pressed, 0, sizeof(record->pressed));
+  record->move = 0;
+  record->mouse_moved = false;
+  record->paint_begin = false;
+  record->spans_count = 0;
+
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
+      case SDL_QUIT: {
+        record->pressed[(size_t)Action::Quit] = true;
+      } break;
+      case SDL_KEYDOWN: {
+        for (const Action_Binding &binding : action_bindings) {
+          if (binding.key == event.key.keysym.sym) {
+            record->pressed[(size_t)binding.action] = true;
+          }
+        }
+      } break;
+      case SDL_MOUSEMOTION: {
+        record->mouse = window_to_render_target(target, vec2(event.motion.x, event.motion.y));
+        record->mouse_moved = true;
+
+        const Vec2i tile = world_to_tile(record->mouse);
+        if (record->painting && (tile.x != record->paint_tile.x || tile.y != record->paint_tile.y)) {
+          push_paint_span(record, record->paint_tile, tile);
+          record->paint_tile = tile;
+        }
+      } break;
+      case SDL_MOUSEBUTTONDOWN: {
+        record->mouse = window_to_render_target(target, vec2(event.button.x, event.button.y));
+        const Vec2i tile = world_to_tile(record->mouse);
+        // * A new drag within the tick replaces the previous ones
+        record->painting = true;
+        record->paint_begin = true;
+        record->paint_tile = tile;
+        record->spans_count = 0;
+        push_paint_span(record, tile, tile);
+      } break;
+      case SDL_MOUSEBUTTONUP: {
+        record->painting = false;
+      } break;
+      default: break;
+    }
+  }
+
+  // * Held keys are read once per tick
+  const Uint8 *keyboard = SDL_GetKeyboardState(nullptr);
+  if (keyboard[SDL_SCANCODE_D]) {
+    record->move = 1;
+  } else if (keyboard[SDL_SCANCODE_A]) {
+    record->move = -1;
+  }
+}
+
+Player_Input get_player_input(const Input_Record *record) {
+  assert(record);
+  Player_Input input = {};
+  input.move = record->move;
+  input.jump = is_action_pressed(record, Action::Jump);
+  input.shoot = is_action_pressed(record, Action::Shoot);
+  input.respawn = is_action_pressed(record, Action::Respawn);
+  return input;
+}
+
+// * Rasterises the painted spans (Bresenham) into tile edits of the tick
+void push_painted_tiles(const Input_Record *record, Tick_Input *input, Tile value) {
+  assert(record);
+  for (size_t i = 0; i < record->spans_count; ++i) {
+    Vec2i p = record->spans[i].from;
+    const Vec2i to = record->spans[i].to;
+    const int dx = std::abs(to.x - p.x), sx = p.x < to.x ? 1 : -1;
+    const int dy = -std::abs(to.y - p.y), sy = p.y < to.y ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+      if (is_tile_inbounds(p)) {
+        push_tile_edit(input, p, value);
+      }
+      if (p.x == to.x && p.y == to.y) break;
+      const int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; p.x += sx; }
+      if (e2 <= dx) { err += dx; p.y += sy; }
+    }
+  }
+}
@@ -11,7 +11,8 @@ const int LEVEL_WIDTH = 10;
 const int LEVEL_HEIGHT = 10;
 const SDL_Rect level_boundary = {0, 0, LEVEL_WIDTH * TILE_SIZE, LEVEL_HEIGHT * TILE_SIZE};
 
-Tile level[LEVEL_HEIGHT][LEVEL_WIDTH] = {
+// * Layout every new level starts from
+const Tile default_level[LEVEL_HEIGHT][LEVEL_WIDTH] = {
   {Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, },
   {Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, },
   {Tile::Empty, Tile::Empty, Tile::Wall,  Tile::Empty, Tile::Empty, Tile::Empty, Tile::Wall,  Tile::Empty, Tile::Empty, Tile::Empty, },
@@ -24,40 +25,196 @@ Tile level[LEVEL_HEIGHT][LEVEL_WIDTH] = {
   {Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, Tile::Empty, }};
 
 
+// * Sprite variants a wall tile can be drawn with
+enum class Tile_Sprite : uint8_t {
+  Top_Ground = 0, // * nothing solid above
+  Bottom_Ground,
+  Count
+};
+
+const size_t LEVEL_DIRTY_RECTS_CAPACITY = 16;
+
+struct Level {
+  Tile tiles[LEVEL_HEIGHT][LEVEL_WIDTH];
+  // * Sprite variant of every wall tile, kept in sync with `tiles`
+  Tile_Sprite autotile[LEVEL_HEIGHT][LEVEL_WIDTH];
+
+  // * Regions (in tile coordinates) edited since the last flush
+  SDL_Rect dirty_rects[LEVEL_DIRTY_RECTS_CAPACITY];
+  size_t dirty_rects_count;
+
+  // * Identifies the content of `tiles`: every edit gets a new, never reused
+  // * revision. Lets snapshots skip copying tiles that did not change.
+  uint32_t revision;
+  uint32_t next_revision;
+};
+
+// * Pixel position -> tile that contains it
+static inline
+Vec2i world_to_tile(Vec2i p) {
+  return floor_div<TILE_SIZE>(p);
+}
+
+// * Tile -> pixel position of its top left corner
+static inline
+Vec2i tile_to_world(Vec2i tile) {
+  return tile * TILE_SIZE;
+}
+
 static inline
 bool is_tile_inbounds(Vec2i p) {
   return 0 <= p.x && p.x < LEVEL_WIDTH && 0 <= p.y && p.y < LEVEL_HEIGHT;
 }
 
-bool is_tile_empty(Vec2i p) {
-  return !is_tile_inbounds(p) || level[p.y][p.x] == Tile::Empty;
+bool is_tile_empty(const Level *level, Vec2i p) {
+  return !is_tile_inbounds(p) || level->tiles[p.y][p.x] == Tile::Empty;
+}
+
+// * ####################
+// * Level edits
+// * ####################
+
+static inline
+SDL_Rect rect_union(SDL_Rect a, SDL_Rect b) {
+  const int x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+  const int x1 = std::max(a.x + a.w, b.x + b.w), y1 = std::max(a.y + a.h, b.y + b.h);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+// * Overlapping or edge adjacent
+static inline
+bool rects_touch(SDL_Rect a, SDL_Rect b) {
+  return a.x <= b.x + b.w && b.x <= a.x + a.w &&
+         a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+void mark_level_dirty(Level *level, SDL_Rect rect) {
+  assert(level);
+
+  // * Grow an existing region if the new one touches it
+  for (size_t i = 0; i < level->dirty_rects_count; ++i) {
+    if (rects_touch(level->dirty_rects[i], rect)) {
+      level->dirty_rects[i] = rect_union(level->dirty_rects[i], rect);
+      return;
+    }
+  }
+
+  // * Out of slots: fold into the last region instead of losing the edit
+  if (level->dirty_rects_count == LEVEL_DIRTY_RECTS_CAPACITY) {
+    SDL_Rect *last = &level->dirty_rects[LEVEL_DIRTY_RECTS_CAPACITY - 1];
+    *last = rect_union(*last, rect);
+    return;
+  }
+
+  level->dirty_rects[level->dirty_rects_count++] = rect;
+}
+
+// * Changes the tile and records the edit. Returns whether anything changed.
+// * The edits are handed to the subscribers on flush_level_edits().
+bool set_tile(Level *level, Vec2i tile, Tile value) {
+  assert(level);
+  if (!is_tile_inbounds(tile) || level->tiles[tile.y][tile.x] == value) {
+    return false;
+  }
+
+  level->tiles[tile.y][tile.x] = value;
+  level->revision = level->next_revision++;
+  mark_level_dirty(level, {tile.x, tile.y, 1, 1});
+  return true;
+}
+
+// * ####################
+// * Autotiling
+// * ####################
+
+// * Bits of the 8-neighbour mask, set when the neighbour is a wall
+const uint8_t NEIGHBOUR_N  = 1 << 0;
+const uint8_t NEIGHBOUR_NE = 1 << 1;
+const uint8_t NEIGHBOUR_E  = 1 << 2;
+const uint8_t NEIGHBOUR_SE = 1 << 3;
+const uint8_t NEIGHBOUR_S  = 1 << 4;
+const uint8_t NEIGHBOUR_SW = 1 << 5;
+const uint8_t NEIGHBOUR_W  = 1 << 6;
+const uint8_t NEIGHBOUR_NW = 1 << 7;
+
+const Vec2i neighbour_offsets[8] = {
+  {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+};
+
+const size_t AUTOTILE_MASKS_COUNT = 256;
+
+// * Neighbour mask -> sprite variant. New variants (edges, corners, ...)
+// * only need a rule here.
+constexpr Tile_Sprite autotile_rule(uint8_t mask) {
+  return (mask & NEIGHBOUR_N) ? Tile_Sprite::Bottom_Ground : Tile_Sprite::Top_Ground;
+}
+
+struct Autotile_Table {
+  Tile_Sprite sprites[AUTOTILE_MASKS_COUNT];
+};
+
+constexpr Autotile_Table make_autotile_table() {
+  Autotile_Table table = {};
+  for (size_t mask = 0; mask < AUTOTILE_MASKS_COUNT; ++mask) {
+    table.sprites[mask] = autotile_rule((uint8_t)mask);
+  }
+  return table;
+}
+
+constexpr Autotile_Table autotile_table = make_autotile_table();
+
+uint8_t get_neighbour_mask(const Level *level, Vec2i tile) {
+  uint8_t mask = 0;
+  for (int i = 0; i < 8; ++i) {
+    if (!is_tile_empty(level, tile + neighbour_offsets[i])) {
+      mask |= (uint8_t)(1 << i);
+    }
+  }
+  return mask;
+}
+
+// * Recomputes the autotile of the region plus its 1 tile border, as the
+// * neighbours of an edited tile change their mask too
+void update_level_autotile(Level *level, SDL_Rect dirty) {
+  assert(level);
+  const int x0 = std::max(dirty.x - 1, 0);
+  const int y0 = std::max(dirty.y - 1, 0);
+  const int x1 = std::min(dirty.x + dirty.w + 1, LEVEL_WIDTH);
+  const int y1 = std::min(dirty.y + dirty.h + 1, LEVEL_HEIGHT);
+
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      level->autotile[y][x] = autotile_table.sprites[get_neighbour_mask(level, vec2(x, y))];
+    }
+  }
+}
+
+void init_level(Level *level, const Tile tiles[LEVEL_HEIGHT][LEVEL_WIDTH]) {
+  assert(level);
+  *level = {};
+  memcpy(level->tiles, tiles, sizeof(level->tiles));
+  level->revision = 0;
+  level->next_revision = 1;
+  update_level_autotile(level, {0, 0, LEVEL_WIDTH, LEVEL_HEIGHT});
 }
 
-void render_level(SDL_Renderer *renderer, Sprite top_ground_texture, Sprite bottom_ground_texture) {
+void render_level(SDL_Renderer *renderer, const Level *level, const Sprite *tile_sprites) {
   for (int y = 0; y < LEVEL_HEIGHT; ++y) {
     for (int x = 0; x < LEVEL_WIDTH; ++x) {
-      switch (level[y][x])
+      switch (level->tiles[y][x])
       {
       case Tile::Empty:
         break;
       case Tile::Wall:
       {
+        const Vec2i p = tile_to_world(vec2(x, y));
         SDL_Rect dstrect = {
-            x * TILE_SIZE,
-            y * TILE_SIZE,
+            p.x,
+            p.y,
             TILE_SIZE, TILE_SIZE};
-        if (is_tile_empty(vec2(x, y - 1)))
-        {
-          render_sprite(renderer,
-                        top_ground_texture,
-                        dstrect);
-        }
-        else
-        {
-          render_sprite(renderer,
-                          bottom_ground_texture,
-                          dstrect);
-        }
+        render_sprite(renderer,
+                      tile_sprites[(size_t)level->autotile[y][x]],
+                      dstrect);
       }
       break;
 
@@ -69,12 +226,12 @@ void render_level(SDL_Renderer *renderer, Sprite top_ground_texture, Sprite bott
 }
 
 
-void dump_level() {
+void dump_level(const Level *level) {
   std::printf("{\n");
   for (int y = 0; y < LEVEL_HEIGHT; ++y) {
     std::printf("{");
     for (int x = 0; x < LEVEL_WIDTH; ++x) {
-      switch (level[y][x])
+      switch (level->tiles[y][x])
       {
 
       case Tile::Empty: {
@@ -0,0 +1,178 @@
+// * ####################
+// * Line of Sight
+// * ####################
+
+static inline
+int64_t floor_div_i64(int64_t a, int64_t b) {
+  const int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// * Clips the segment a->b to `rect`, edges included (Liang & Barsky). The
+// * parameters are integer fractions and the points are rounded down, so
+// * they land in the same tiles as the exact ones. False when the segment
+// * misses the rect.
+static inline
+bool clip_segment(SDL_Rect rect, Vec2i *a, Vec2i *b) {
+  const int64_t dx = (int64_t)b->x - a->x;
+  const int64_t dy = (int64_t)b->y - a->y;
+  const int64_t p[4] = {-dx, dx, -dy, dy};
+  const int64_t q[4] = {
+    (int64_t)a->x - rect.x, (int64_t)rect.x + rect.w - a->x,
+    (int64_t)a->y - rect.y, (int64_t)rect.y + rect.h - a->y,
+  };
+
+  // * Enters the rect at t0 = t0_num / t0_den and leaves it at t1
+  int64_t t0_num = 0, t0_den = 1, t1_num = 1, t1_den = 1;
+  for (int i = 0; i < 4; ++i) {
+    if (p[i] == 0) {
+      // * Parallel to that side and outside of it
+      if (q[i] < 0) return false;
+      continue;
+    }
+    const int64_t num = p[i] < 0 ? -q[i] : q[i];
+    const int64_t den = std::abs(p[i]);
+    if (p[i] < 0) {
+      if (num * t0_den > t0_num * den) { t0_num = num; t0_den = den; }
+    } else {
+      if (num * t1_den < t1_num * den) { t1_num = num; t1_den = den; }
+    }
+  }
+  if (t0_num * t1_den > t1_num * t0_den) return false;
+
+  const Vec2i from = vec2((int)(a->x + floor_div_i64(dx * t0_num, t0_den)),
+                          (int)(a->y + floor_div_i64(dy * t0_num, t0_den)));
+  *b = vec2((int)(a->x + floor_div_i64(dx * t1_num, t1_den)),
+            (int)(a->y + floor_div_i64(dy * t1_num, t1_den)));
+  *a = from;
+  return true;
+}
+
+// * A point on the right or bottom edge of the level is in the tile next to
+// * it, outside of the level
+static inline
+Vec2i clamp_tile(Vec2i tile) {
+  return vec2(std::clamp(tile.x, 0, LEVEL_WIDTH - 1), std::clamp(tile.y, 0, LEVEL_HEIGHT - 1));
+}
+
+// * Walks the tiles crossed by the segment a->b (Amanatides & Woo grid
+// * traversal) and reports whether none of them is a wall. Boundary crossings
+// * are compared with integer cross multiplication, no floating point.
+bool is_segment_clear(const Level *level, Vec2i a, Vec2i b) {
+  // * Outside of the level every tile is empty, only the part inside is
+  // * walked. The crossings are still measured on the whole segment.
+  Vec2i from = a, to = b;
+  if (!clip_segment(level_boundary, &from, &to)) return true;
+
+  Vec2i tile = clamp_tile(world_to_tile(from));
+  const Vec2i end = clamp_tile(world_to_tile(to));
+
+  const int64_t dx = std::abs((int64_t)b.x - a.x);
+  const int64_t dy = std::abs((int64_t)b.y - a.y);
+  const int sx = b.x > a.x ? 1 : -1;
+  const int sy = b.y > a.y ? 1 : -1;
+
+  // * Never more steps than the manhattan distance in tiles
+  const int steps = std::abs(end.x - tile.x) + std::abs(end.y - tile.y);
+  for (int i = 0; i <= steps; ++i) {
+    if (!is_tile_empty(level, tile)) return false;
+    if (tile.x == end.x && tile.y == end.y) return true;
+
+    // * Distance from `a` to the next vertical/horizontal tile boundary
+    const Vec2i p = tile_to_world(tile);
+    const int64_t nx = sx > 0 ? (int64_t)p.x + TILE_SIZE - a.x : (int64_t)a.x - p.x;
+    const int64_t ny = sy > 0 ? (int64_t)p.y + TILE_SIZE - a.y : (int64_t)a.y - p.y;
+
+    // * nx / dx < ny / dy: the segment leaves the tile through a vertical side
+    if (tile.x != end.x && (tile.y == end.y || nx * dy <= ny * dx)) {
+      tile.x += sx;
+    } else {
+      tile.y += sy;
+    }
+  }
+  return true;
+}
+
+// * Visibility between tile centres, cached per (source tile, target tile)
+// * pair and invalidated by level edits. The answer is shared by every point
+// * inside the two tiles, which is plenty for AI checks.
+
+enum class Line_Of_Sight : uint8_t {
+  Unknown = 0,
+  Clear,
+  Blocked
+};
+
+const int LEVEL_TILES_COUNT = LEVEL_WIDTH * LEVEL_HEIGHT;
+
+struct Line_Of_Sight_Cache {
+  Line_Of_Sight pairs[LEVEL_TILES_COUNT][LEVEL_TILES_COUNT];
+};
+
+static inline
+int get_tile_index(Vec2i tile) {
+  return tile.y * LEVEL_WIDTH + tile.x;
+}
+
+static inline
+Vec2i get_tile_centre(Vec2i tile) {
+  return tile_to_world(tile) + TILE_SIZE / 2;
+}
+
+bool has_line_of_sight(Line_Of_Sight_Cache *cache, const Level *level, Vec2i from, Vec2i to) {
+  assert(cache);
+  const Vec2i a = world_to_tile(from);
+  const Vec2i b = world_to_tile(to);
+
+  // * Outside of the level there is nothing to cache
+  if (!is_tile_inbounds(a) || !is_tile_inbounds(b)) {
+    return is_segment_clear(level, from, to);
+  }
+
+  const int ia = get_tile_index(a), ib = get_tile_index(b);
+  if (cache->pairs[ia][ib] == Line_Of_Sight::Unknown) {
+    const bool clear = is_segment_clear(level, get_tile_centre(a), get_tile_centre(b));
+    const Line_Of_Sight result = clear ? Line_Of_Sight::Clear : Line_Of_Sight::Blocked;
+    // * Symmetric
+    cache->pairs[ia][ib] = result;
+    cache->pairs[ib][ia] = result;
+  }
+  return cache->pairs[ia][ib] == Line_Of_Sight::Clear;
+}
+
+struct Line_Of_Sight_Query {
+  Vec2i from;
+  Vec2i to;
+};
+
+// * Answers `count` queries at once, results[i] is the visibility of queries[i]
+void query_line_of_sight(Line_Of_Sight_Cache *cache,
+                         const Level *level,
+                         const Line_Of_Sight_Query *queries,
+                         bool *results,
+                         size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    results[i] = has_line_of_sight(cache, level, queries[i].from, queries[i].to);
+  }
+}
+
+// * A segment between two tile centres only crosses tiles inside the bounding
+// * box of the two tiles, so only pairs whose box touches the edit are dropped
+void invalidate_line_of_sight(Line_Of_Sight_Cache *cache, SDL_Rect dirty) {
+  assert(cache);
+  for (int ia = 0; ia < LEVEL_TILES_COUNT; ++ia) {
+    const int ax = ia % LEVEL_WIDTH, ay = ia / LEVEL_WIDTH;
+    for (int ib = 0; ib < LEVEL_TILES_COUNT; ++ib) {
+      if (cache->pairs[ia][ib] == Line_Of_Sight::Unknown) continue;
+
+      const int bx = ib % LEVEL_WIDTH, by = ib / LEVEL_WIDTH;
+      const int x0 = std::min(ax, bx), x1 = std::max(ax, bx);
+      const int y0 = std::min(ay, by), y1 = std::max(ay, by);
+      if (x0 < dirty.x + dirty.w && dirty.x <= x1 &&
+          y0 < dirty.y + dirty.h && dirty.y <= y1) {
+        cache->pairs[ia][ib] = Line_Of_Sight::Unknown;
+      }
+    }
+  }
+}
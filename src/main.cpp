@@ -11,18 +11,15 @@
 #define COLOR_RED 0xff, 0x00, 0x00, 0xff
 #define COLOR_YELLOW 0xff, 0xff, 0x00, 0xff
 
-const int PLAYER_SPEED = 2;
-const int PLAYER_TEXBOX_SIZE = 48;
-const int PLAYER_HITBOX_SIZE = (PLAYER_TEXBOX_SIZE - 10);
-
 template <typename T>
 T max(T n1, T n2) {
   return n1 > n2 ? n1 : n2;
 }
 
 SDL_Rect get_entity_htibox(const Entity entity) {
+  const Vec2i pos = vec2_floor(entity.pos);
   SDL_Rect hitbox = {
-      entity.hitbox.x + entity.pos.x, entity.hitbox.y + entity.pos.y,
+      entity.hitbox.x + pos.x, entity.hitbox.y + pos.y,
       entity.hitbox.w, entity.hitbox.h};
   return hitbox;
 }
@@ -38,6 +35,77 @@ void render_texture(SDL_Texture *texture, SDL_Renderer *renderer, Vec2i pos) {
 const size_t DIGITS_COUNT = 120;
 SDL_Texture *digits_textures[DIGITS_COUNT];
 
+// * Text textures are kept around while the text does not change, so a
+// * steady debug overlay does not create & destroy textures every frame
+struct Text_Texture {
+  char *text;
+  size_t text_capacity;
+  SDL_Color color;
+  SDL_Texture *texture;
+  uint64_t last_used;
+};
+
+const size_t TEXT_TEXTURES_COUNT = 64;
+const size_t TEXT_TEXTURE_TEXT_CAPACITY = 256;
+Text_Texture text_textures[TEXT_TEXTURES_COUNT] = {};
+uint64_t text_textures_clock = 0;
+
+SDL_Texture *get_text_texture(SDL_Renderer *renderer,
+                              TTF_Font *font,
+                              const char *text,
+                              SDL_Color color)
+{
+  text_textures_clock += 1;
+
+  size_t lru = 0;
+  for (size_t i = 0; i < TEXT_TEXTURES_COUNT; ++i) {
+    Text_Texture *entry = &text_textures[i];
+    if (entry->texture &&
+        memcmp(&entry->color, &color, sizeof(color)) == 0 &&
+        strcmp(entry->text, text) == 0) {
+      entry->last_used = text_textures_clock;
+      return entry->texture;
+    }
+
+    if (entry->last_used < text_textures[lru].last_used) {
+      lru = i;
+    }
+  }
+
+  // * Cache miss: evict the least recently used entry
+  Text_Texture *entry = &text_textures[lru];
+  if (entry->texture) {
+    record_texture_destroyed(entry->texture);
+    SDL_DestroyTexture(entry->texture);
+  }
+  if (entry->text == nullptr) {
+    entry->text = arena_alloc_array<char>(&asset_arena, TEXT_TEXTURE_TEXT_CAPACITY);
+    entry->text_capacity = TEXT_TEXTURE_TEXT_CAPACITY;
+  }
+  snprintf(entry->text, entry->text_capacity, "%s", text);
+  entry->color = color;
+  entry->texture = render_text_as_texture(font, renderer, entry->text, color);
+  entry->last_used = text_textures_clock;
+  return entry->texture;
+}
+
+// * Draws `text` and returns its width
+int render_text_run(SDL_Renderer *renderer,
+                    TTF_Font *font,
+                    const char *text,
+                    SDL_Color color,
+                    Vec2i pos)
+{
+  SDL_Texture *texture = get_text_texture(renderer, font, text, color);
+  int w = 0;
+  sec(SDL_QueryTexture(texture, nullptr, nullptr, &w, nullptr));
+  render_texture(texture, renderer, pos);
+  return w;
+}
+
+// * Every digit gets its own texture and the text between digits one texture
+// * per run, so numbers that change every frame (mouse position, timings)
+// * reuse cached textures instead of rendering the whole line again
 void displayf(SDL_Renderer *renderer,
              TTF_Font *font,
              SDL_Color color,
@@ -46,16 +114,35 @@ void displayf(SDL_Renderer *renderer,
 {
   va_list args;
   va_start(args, format);
+  va_list args_copy;
+  va_copy(args_copy, args);
+
+  // * Format the text into the frame arena
+  const int text_size = vsnprintf(nullptr, 0, format, args);
+  assert(text_size >= 0);
+  char *text = arena_alloc_array<char>(&frame_arena, (size_t) text_size + 1);
+  vsnprintf(text, (size_t) text_size + 1, format, args_copy);
+
+  size_t run_begin = 0;
+  for (size_t i = 0; ; ++i) {
+    const char c = text[i];
+    const bool digit = c >= '0' && c <= '9';
+    if (c != '\0' && !digit) continue;
+
+    // * The run before the digit, cut in place
+    if (i > run_begin) {
+      text[i] = '\0';
+      pos.x += render_text_run(renderer, font, text + run_begin, color, pos);
+      text[i] = c;
+    }
+    if (c == '\0') break;
 
-  char text[256];
-  vsnprintf(text, sizeof(text), format, args);
-  
-   // * Creates a SDL_Texture from text
-   SDL_Texture *texture = render_text_as_texture(font, renderer, text, color);
-   // * Render texture onto screen
-  render_texture(texture, renderer, pos);
-  SDL_DestroyTexture(texture);
-  
+    const char glyph[2] = {c, '\0'};
+    pos.x += render_text_run(renderer, font, glyph, color, pos);
+    run_begin = i + 1;
+  }
+
+  va_end(args_copy);
   va_end(args);
 }
 
@@ -65,8 +152,87 @@ enum class Debug_Draw_State {
   Delete
 };
 
-int main(void) {
+World_Assets load_world_assets(SDL_Renderer *renderer) {
+  World_Assets assets = {};
+  init_entity_boxes(&assets);
+
+  // * Player Texture
+  assets.walking = load_spritesheet_animat(renderer, WALKING_FRAME_COUNT, WALKING_FRAME_DURATION, WALKING_FILEPATH);
+
+  // * Player Idle Animation
+  assets.idle = {
+      .frames = assets.walking.frames + 2, // * 3rd frame
+      .frames_count = 1,
+      .frame_current = 0,
+      .frame_duration = 100,
+      .frame_cooldown = 0};
+
+  // * Initialize the projectiles animats
+  assets.projectile_active = load_spritesheet_animat(renderer, PLASMA_POP_FRAME_COUNT, PLASMA_POP_FRAME_DURATION, PROJECTILE_SPARK_FILEPATH);
+  return assets;
+}
+
+const Uint64 BATCH_TICK_DT = 16;
+
+// * $ game --batch <worlds> <ticks> [threads]
+int run_batch(int argc, char **argv) {
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s --batch <worlds> <ticks> [threads]\n", argv[0]);
+    return 1;
+  }
+  const size_t worlds_count = strtoull(argv[2], nullptr, 10);
+  const size_t ticks = strtoull(argv[3], nullptr, 10);
+  const size_t threads_count = argc > 4 ? strtoull(argv[4], nullptr, 10) : 0;
+
+  const World_Assets assets = headless_world_assets();
+  World *worlds = new World[worlds_count];
+  Bot *bots = new Bot[worlds_count];
+  for (size_t i = 0; i < worlds_count; ++i) {
+    init_world(&worlds[i], &assets);
+    bots[i] = make_bot((uint32_t)(i + 1));
+  }
+
+  const Uint64 begin = SDL_GetPerformanceCounter();
+  run_world_batch(worlds, bots, worlds_count, ticks, BATCH_TICK_DT, threads_count);
+  const double secs = (double)(SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+
+  // * A player that fell out of the level got respawned, its position says
+  // * nothing about the bot anymore
+  size_t projectiles_alive = 0;
+  size_t players_lost = 0;
+  double player_x = 0.0;
+  for (size_t i = 0; i < worlds_count; ++i) {
+    for (size_t j = 0; j < projectiles_count; ++j) {
+      projectiles_alive += worlds[i].projectiles.projectiles[j].state != Projectile_State::Ded;
+    }
+    if (worlds[i].player_falls_count > 0) {
+      players_lost += 1;
+      continue;
+    }
+    player_x += fixed_floor(get_player(&worlds[i])->pos.x);
+  }
+  const size_t players_kept = worlds_count - players_lost;
+
+  printf("worlds: %zu, ticks: %zu, time: %.3fs, world ticks/s: %.0f\n",
+         worlds_count, ticks, secs, (double)(worlds_count * ticks) / secs);
+  printf("projectiles alive: %zu, average player x: %.1f\n",
+         projectiles_alive, players_kept ? player_x / (double)players_kept : 0.0);
+  if (players_lost > 0) {
+    printf("worlds that lost their player: %zu\n", players_lost);
+  }
+
+  delete[] bots;
+  delete[] worlds;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+    return run_batch(argc, argv);
+  }
+
   sec(SDL_Init(SDL_INIT_VIDEO));
+  open_metrics();
 
   // * Initialize the SDL Window
   SDL_Window *window = sec(SDL_CreateWindow(
@@ -94,172 +260,175 @@ int main(void) {
       .rect = {120, 128 + 10, 22, 22},
       .texture = tileset_texture};
 
-  // * Player Texture
-  const int walking_frame_count = 4, walking_frame_duration = 100;
-  Animat walking = load_spritesheet_animat(renderer, walking_frame_count, walking_frame_duration, WALKING_FILEPATH);
-
-  SDL_Rect texbox = {
-      -(PLAYER_TEXBOX_SIZE / 2), -(PLAYER_TEXBOX_SIZE / 2), PLAYER_TEXBOX_SIZE, PLAYER_TEXBOX_SIZE};
-
-  SDL_Rect hitbox = {
-      -(PLAYER_HITBOX_SIZE / 2), -(PLAYER_HITBOX_SIZE / 2), PLAYER_HITBOX_SIZE - 10, PLAYER_HITBOX_SIZE};
-
-  // * Player Idle Animation
-  Animat idle = {
-      .frames = walking.frames + 2, // * 3rd frame
-      .frames_count = 1,
-      .frame_current = 0,
-      .frame_duration = 100,
-      .frame_cooldown = 0};
-
-  // * Define Player
-  Entity player = { 
-    .texbox = texbox, 
-    .hitbox = hitbox,
-    .walking = walking,
-    .idle = idle,
-    .current = &player.idle
- };
-
-  // * Define Enemy
-  Entity supposed_enemy = { 
-    .texbox = texbox, 
-    .hitbox = hitbox,
-    .walking = walking,
-    .idle = idle,
-    .current = &supposed_enemy.idle
- };
- supposed_enemy.pos = vec2(100, 0);
-
-  // * Initialize the projectiles animats
-  Animat plasma_pop_animat = load_spritesheet_animat(renderer, 5, 200, PROJECTILE_SPARK_FILEPATH);
-  Animat plasma_poof_animat = load_spritesheet_animat(renderer, 4, 200, PROJECTILE_DESTORY_FILEPATH);
-  init_projectiles(plasma_pop_animat, plasma_poof_animat);
+  // * Indexed by Tile_Sprite
+  Sprite tile_sprites[(size_t)Tile_Sprite::Count] = {};
+  tile_sprites[(size_t)Tile_Sprite::Top_Ground] = ground_grass_texture;
+  tile_sprites[(size_t)Tile_Sprite::Bottom_Ground] = ground_texture;
+
+  const World_Assets assets = load_world_assets(renderer);
+  World world = {};
+  init_world(&world, &assets);
+  Entity *player = get_player(&world);
+
+  static Scheduler scheduler = {};
+  spawn_patrol_guards(&scheduler, &world, &assets);
+
+  // * Projectile impacts are played as particles
+  Animat impact_animat = load_spritesheet_animat(renderer, PLASMA_POOF_FRAME_COUNT, PLASMA_POOF_FRAME_DURATION, PROJECTILE_DESTORY_FILEPATH);
+  const Particle_Atlas particle_atlas = make_particle_atlas(renderer, &impact_animat);
+  static Particle_Pool particles;
+  init_particles(&particles);
+
+  // * Big & long lived, keep them off the stack
+  static Rollback rollback = {};
+  static Snapshot_Store<1> quick_save = {};
+  // * Pretend a peer confirms our input this many ticks late and re-simulate
+  // * the ticks every frame, like a networked rollback would
+  const size_t ROLLBACK_TEST_TICKS = 8;
+  bool rollback_test = false;
+  Uint64 resimulate_time = 0;
 
   const int COLLISION_PROBE_SIZE = 10;
+  // * The world is drawn at SCREEN_WIDTH x SCREEN_HEIGHT whatever the window size
+  SDL_DisplayMode display_mode = {};
+  const int display_index = SDL_GetWindowDisplayIndex(window);
+  sec(display_index);
+  sec(SDL_GetCurrentDisplayMode(display_index, &display_mode));
+  Render_Target render_target = make_render_target(renderer, SCREEN_WIDTH, SCREEN_HEIGHT, display_mode.refresh_rate);
+
   Vec2i mouse_position = {};
   SDL_Rect collision_probe = {}, tile_rect = {};
   Debug_Draw_State state = Debug_Draw_State::Idle;
+  Input_Record input_record = {};
   
-  const Vec2i gravity = vec2(0, 1);
   uint64_t fps = 0;
+  Uint64 dt = 0;
   bool quit = false, debug = false;
-  const Uint8* keyboard = SDL_GetKeyboardState(NULL);
 
   while (!quit) {
     const Uint64 begin = SDL_GetTicks64();
+    const Uint64 frame_begin = SDL_GetPerformanceCounter();
+    arena_reset(&frame_arena);
+    Tick_Input input = {};
 
-    SDL_Event event;
-    while(SDL_PollEvent(&event)) {
-      switch (event.type) {
-        case SDL_QUIT: {
-          quit = true;
-        } break;
-        case SDL_KEYDOWN: {
-          switch (event.key.keysym.sym) {
-          case SDLK_SPACE: {
-            player.vel.y = -20;
-          } break;
-          case SDLK_l: {
-            quit = true;
-          } break;
-          case SDLK_e: {
-            entity_shoot(&player);
-          } break;
-          case SDLK_q: {
-            debug = !debug;
-          } break;
-          case SDLK_r: {
-            player.vel.y = 0;
-            player.pos = vec2(0, 0);
-          } break;
-
-          default:
-            break;
-          }
-        } break;
-        case SDL_MOUSEMOTION: {
-          Vec2i p = {event.motion.x, event.motion.y};
-          resolve_point_collision(&p);
-
-          collision_probe = {
-              p.x - COLLISION_PROBE_SIZE, p.y - COLLISION_PROBE_SIZE,
-              COLLISION_PROBE_SIZE * 2, COLLISION_PROBE_SIZE * 2};
-              
-          tile_rect = {
-              (event.motion.x / TILE_SIZE) * TILE_SIZE,
-              (event.motion.y / TILE_SIZE) * TILE_SIZE,
-              TILE_SIZE, TILE_SIZE};
-
-          mouse_position = {event.motion.x, event.motion.y};
-
-          Vec2i tile = vec2(event.motion.x, event.motion.y) / TILE_SIZE;
-          switch(state) {
-            case Debug_Draw_State::Idle: {
-            } break;
-            case Debug_Draw_State::Create: {
-              if (is_tile_inbounds(tile))
-              level[tile.y][tile.x] = Tile::Wall;
-            } break;
-            case Debug_Draw_State::Delete: {
-              if (is_tile_inbounds(tile))
-                level[tile.y][tile.x] = Tile::Empty;
-            } break;
-            default: {}
-          }
-
-        } break;
-        case SDL_MOUSEBUTTONDOWN: {
-          if(debug) {
-            Vec2i tile = vec2(event.motion.x, event.motion.y) / TILE_SIZE;
-            if(is_tile_inbounds(tile)) {
-              if(level[tile.y][tile.x] == Tile::Empty) {
-                state = Debug_Draw_State::Create;
-                level[tile.y][tile.x] = Tile::Wall;
-              }
-              else {
-                state = Debug_Draw_State::Delete;
-                level[tile.y][tile.x] = Tile::Empty;
-              }
-            }
-          }
-        } break;
-        case SDL_MOUSEBUTTONUP: {
-          state = Debug_Draw_State::Idle; 
-        } break;
+    // * Drain the events of the frame into one record
+    poll_input(&input_record, &render_target);
+    input.player = get_player_input(&input_record);
+
+    if (is_action_pressed(&input_record, Action::Quit)) {
+      quit = true;
+    }
+    if (is_action_pressed(&input_record, Action::Toggle_Debug)) {
+      debug = !debug;
+    }
+    if (is_action_pressed(&input_record, Action::Toggle_Rollback_Test)) {
+      rollback_test = !rollback_test;
+    }
+    if (is_action_pressed(&input_record, Action::Quick_Save)) {
+      save_snapshot(&quick_save, 0, &world);
+    }
+    if (is_action_pressed(&input_record, Action::Quick_Load)) {
+      if (is_snapshot_valid(&quick_save, 0)) {
+        restore_snapshot(&quick_save, 0, &world);
+        rollback_reset(&rollback);
       }
     }
 
-    entity_shoot(&supposed_enemy);
+    // * Only the latest mouse position of the tick matters
+    if (input_record.mouse_moved) {
+      mouse_position = input_record.mouse;
+      Vec2i p = mouse_position;
+      resolve_point_collision(&world.level, &p);
+
+      collision_probe = {
+          p.x - COLLISION_PROBE_SIZE, p.y - COLLISION_PROBE_SIZE,
+          COLLISION_PROBE_SIZE * 2, COLLISION_PROBE_SIZE * 2};
+
+      const Vec2i tile_pos = tile_to_world(world_to_tile(mouse_position));
+      tile_rect = {
+          tile_pos.x, tile_pos.y,
+          TILE_SIZE, TILE_SIZE};
+    }
+
+    // * Painting walls or holes, depending on the tile the drag started on
+    if (input_record.paint_begin && debug) {
+      const Vec2i tile = input_record.spans[0].from;
+      if (is_tile_inbounds(tile)) {
+        state = world.level.tiles[tile.y][tile.x] == Tile::Empty
+          ? Debug_Draw_State::Create
+          : Debug_Draw_State::Delete;
+      }
+    }
+    switch(state) {
+      case Debug_Draw_State::Idle: {
+      } break;
+      case Debug_Draw_State::Create: {
+        push_painted_tiles(&input_record, &input, Tile::Wall);
+      } break;
+      case Debug_Draw_State::Delete: {
+        push_painted_tiles(&input_record, &input, Tile::Empty);
+      } break;
+      default: {}
+    }
+    if (!input_record.painting) {
+      state = Debug_Draw_State::Idle;
+    }
+
+    // * Scripts add their orders to the input of the tick. They run once per
+    // * tick, re-simulated ticks replay the recorded orders.
+    const Uint64 tick_begin = SDL_GetPerformanceCounter();
+    scheduler_tick(&scheduler, &world, &input);
+
+    // * Advance the simulation by the duration of the previous frame
+    rollback_step(&rollback, &world, &input, dt);
+    record_sim_tick_time((SDL_GetPerformanceCounter() - tick_begin) * 1000000 / SDL_GetPerformanceFrequency());
+
+    if (rollback_test) {
+      const Uint64 resimulate_begin = SDL_GetPerformanceCounter();
+      rollback_resimulate(&rollback, &world, std::min<uint64_t>(ROLLBACK_TEST_TICKS, rollback.tick));
+      resimulate_time = (SDL_GetPerformanceCounter() - resimulate_begin) * 1000000 / SDL_GetPerformanceFrequency();
+    }
+
+    for (size_t i = 0; i < world.projectiles.impacts_count; ++i) {
+      spawn_impact_effect(&particles, world.projectiles.impacts[i]);
+    }
+    update_particles(&particles, dt);
 
-    // * Update state
-    if (keyboard[SDL_SCANCODE_D]) {
-      entity_move(&player, PLAYER_SPEED);
-    } else if (keyboard[SDL_SCANCODE_A]) {
-      entity_move(&player, -PLAYER_SPEED);
-    } else {
-      entity_stop(&player);
+    size_t projectiles_alive = 0;
+    for (size_t i = 0; i < projectiles_count; ++i) {
+      projectiles_alive += world.projectiles.projectiles[i].state != Projectile_State::Ded;
     }
+    metric_set(&metrics->entities_count, world.entities_count);
+    metric_set(&metrics->projectiles_count, projectiles_alive);
+    metric_set(&metrics->particles_count, particles.count);
 
     // * Render state
     sec(SDL_SetRenderDrawColor(renderer, COLOR_BLACK));
-    sec(SDL_RenderClear(renderer));
-    render_level(renderer, ground_grass_texture, ground_texture);
-    render_entity(renderer, player);
-    render_entity(renderer, supposed_enemy);
-    render_projectiles(renderer);
+    begin_render_target(renderer, &render_target);
+    render_world(renderer, &world, tile_sprites);
+    render_particles(renderer, &particles, &particle_atlas, &impact_animat);
 
     // * Show player hitbox
     if(debug) {
       sec(SDL_SetRenderDrawColor(renderer, COLOR_RED));
       
-      SDL_Rect entity_dstrect = get_entity_dstrect(player);
+      SDL_Rect entity_dstrect = get_entity_dstrect(*player);
       sec(SDL_RenderDrawRect(renderer, &entity_dstrect));
 
       sec(SDL_RenderFillRect(renderer, &collision_probe));
       sec(SDL_RenderDrawRect(renderer, &tile_rect));
       sec(SDL_RenderDrawRect(renderer, &level_boundary));
 
+      sec(SDL_SetRenderDrawColor(renderer, COLOR_YELLOW));
+      SDL_Rect hitbox = get_entity_htibox(*player);
+      sec(SDL_RenderDrawRect(renderer, &hitbox));
+    }
+
+    sec(SDL_SetRenderDrawColor(renderer, COLOR_BLACK));
+    end_render_target(renderer, &render_target);
+
+    // * The text is drawn at the window resolution to stay sharp
+    if(debug) {
       const uint64_t t = SDL_GetTicks64() - begin;
       const uint64_t fps_snapshot = t ? 1000 / t : 0;
       fps = (fps + fps_snapshot) / 2;
@@ -275,23 +444,49 @@ int main(void) {
                {255, 255, 0, 255},
                {0, gap * 2},
                "Collision Probe: (%d %d)", collision_probe.x, collision_probe.y);
-
-      sec(SDL_SetRenderDrawColor(renderer, COLOR_YELLOW));
-      SDL_Rect hitbox = get_entity_htibox(player);
-      sec(SDL_RenderDrawRect(renderer, &hitbox));
+      displayf(renderer,
+               font,
+               {255, 255, 0, 255},
+               {0, gap * 3},
+               "Render Scale: %d%% (missed refreshes: %zu)",
+               render_target.scale, render_target.missed_refreshes_count);
+      displayf(renderer,
+               font,
+               {255, 255, 0, 255},
+               {0, gap * 4},
+               "Frame Arena: %zu/%zu KiB peak, %zu resets",
+               (frame_arena.peak + 1023) / 1024, frame_arena.capacity / 1024, frame_arena.resets_count);
+      displayf(renderer,
+               font,
+               {255, 255, 0, 255},
+               {0, gap * 5},
+               "Scratch Arena: %zu/%zu KiB peak, %zu resets",
+               (scratch_arena.peak + 1023) / 1024, scratch_arena.capacity / 1024, scratch_arena.resets_count);
+      displayf(renderer,
+               font,
+               {255, 255, 0, 255},
+               {0, gap * 6},
+               "Asset Arena: %zu/%zu KiB",
+               (asset_arena.peak + 1023) / 1024, asset_arena.capacity / 1024);
+      if (rollback_test) {
+        displayf(renderer,
+                 font,
+                 {255, 255, 0, 255},
+                 {0, gap * 7},
+                 "Rollback: %zu ticks in %llu us", ROLLBACK_TEST_TICKS, (unsigned long long)resimulate_time);
+      }
     }
 
 
-    SDL_RenderPresent(renderer);
-    const Uint64 dt = SDL_GetTicks64() - begin;
-
-
-    update_entity(&player, gravity, dt);
-    update_entity(&supposed_enemy, gravity, dt);
-    update_projectiles(dt);
+    present_render_target(renderer, &render_target);
+    dt = SDL_GetTicks64() - begin;
+    const uint64_t frame_time = (SDL_GetPerformanceCounter() - frame_begin) * 1000000 / SDL_GetPerformanceFrequency();
+    record_frame_time(frame_time);
   }
 
+  destroy_scheduler(&scheduler);
+  close_metrics();
   SDL_Quit();
-  // dump_level();
+  // dump_level(&world.level);
   return 0;
-}
\ No newline at end of file
+}
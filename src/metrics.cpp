@@ -0,0 +1,194 @@
+// * ####################
+// * Metrics
+// * ####################
+
+// * Counters & gauges of the running game in a shared memory page, so
+// * external tools can watch a soak test by mapping the page read only:
+// *
+// *   /dev/shm/game-metrics.<pid>
+// *
+// * The game only does relaxed atomic stores & adds into the page, no locks
+// * and no syscalls after open_metrics(). Until the page is opened (batch
+// * runs, benchmarks, ...) the metrics go to a private copy.
+// *
+// * The page is unlinked on a clean shutdown. A game that crashed leaves its
+// * page behind, the next game to start removes the pages of dead pids.
+
+const uint32_t METRICS_MAGIC = 0x4d455452; // * "METR"
+const uint32_t METRICS_VERSION = 1;
+
+// * Bucket i counts the frames that took [2^i, 2^(i+1)) us, the last one
+// * everything longer
+const size_t METRICS_FRAME_TIME_BUCKETS = 24;
+
+typedef std::atomic<uint64_t> Metric;
+static_assert(Metric::is_always_lock_free);
+
+// * The layout is the interface with the readers, bump METRICS_VERSION when
+// * it changes
+struct Metrics {
+  uint32_t magic;
+  uint32_t version;
+
+  // * Frames
+  Metric frames_count;
+  Metric frame_time;       // * us, last frame
+  Metric frame_time_buckets[METRICS_FRAME_TIME_BUCKETS];
+
+  // * Simulation
+  Metric sim_ticks_count;
+  Metric sim_tick_time;       // * us, last tick
+  Metric sim_tick_time_total; // * us, all the ticks
+
+  // * Gauges of the last tick
+  Metric entities_count;
+  Metric projectiles_count;
+  Metric particles_count;
+
+  // * Pools
+  Metric projectile_pool_exhausted; // * spawns lost to a full projectile pool
+  Metric particle_pool_exhausted;
+
+  // * Renderer
+  Metric textures_count;
+  Metric texture_bytes; // * estimate, 4 bytes per texel
+};
+
+Metrics private_metrics = {};
+Metrics *metrics = &private_metrics;
+
+// * Set while the rollback simulates past ticks again. Events counted from
+// * inside the simulation only count for the tick as first simulated.
+bool metrics_resimulating = false;
+
+static inline
+void metric_add(Metric *metric, uint64_t n = 1) {
+  metric->fetch_add(n, std::memory_order_relaxed);
+}
+
+static inline
+void metric_sub(Metric *metric, uint64_t n) {
+  metric->fetch_sub(n, std::memory_order_relaxed);
+}
+
+static inline
+void metric_set(Metric *metric, uint64_t value) {
+  metric->store(value, std::memory_order_relaxed);
+}
+
+char metrics_shm_name[64] = {};
+
+const char METRICS_SHM_DIR[] = "/dev/shm";
+const char METRICS_SHM_PREFIX[] = "game-metrics.";
+
+// * Unlinks the pages left behind by games that did not shut down cleanly
+void remove_stale_metrics() {
+  DIR *dir = opendir(METRICS_SHM_DIR);
+  if (!dir) return;
+
+  const size_t prefix_size = sizeof(METRICS_SHM_PREFIX) - 1;
+  for (const dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+    if (strncmp(entry->d_name, METRICS_SHM_PREFIX, prefix_size) != 0) continue;
+
+    char *end = nullptr;
+    const long pid = strtol(entry->d_name + prefix_size, &end, 10);
+    if (*end != '\0' || pid <= 0) continue;
+    // * EPERM means alive but someone else's
+    if (kill((pid_t)pid, 0) == 0 || errno != ESRCH) continue;
+
+    char name[sizeof(metrics_shm_name)];
+    snprintf(name, sizeof(name), "/%s", entry->d_name);
+    if (shm_unlink(name) == 0) {
+      fprintf(stderr, "INFO: metrics: removed stale /dev/shm%s\n", name);
+    }
+  }
+  closedir(dir);
+}
+
+// * Moves the metrics into a shared memory page. Failing is not fatal, the
+// * game keeps the private copy.
+void open_metrics() {
+  remove_stale_metrics();
+  snprintf(metrics_shm_name, sizeof(metrics_shm_name), "/%s%d", METRICS_SHM_PREFIX, (int)getpid());
+
+  const int fd = shm_open(metrics_shm_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "WARNING: metrics: could not open shared memory `%s`: %s\n",
+            metrics_shm_name, strerror(errno));
+    metrics_shm_name[0] = '\0';
+    return;
+  }
+
+  void *page = MAP_FAILED;
+  if (ftruncate(fd, sizeof(Metrics)) == 0) {
+    page = mmap(nullptr, sizeof(Metrics), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (page == MAP_FAILED) {
+    fprintf(stderr, "WARNING: metrics: could not map shared memory `%s`: %s\n",
+            metrics_shm_name, strerror(errno));
+    shm_unlink(metrics_shm_name);
+    metrics_shm_name[0] = '\0';
+    return;
+  }
+
+  // * Carry over what was counted before (asset loading, ...)
+  Metrics *shared = new (page) Metrics();
+  const Metric *src = &metrics->frames_count;
+  Metric *dst = &shared->frames_count;
+  const size_t metrics_count = (sizeof(Metrics) - offsetof(Metrics, frames_count)) / sizeof(Metric);
+  for (size_t i = 0; i < metrics_count; ++i) {
+    metric_set(&dst[i], src[i].load(std::memory_order_relaxed));
+  }
+  shared->version = METRICS_VERSION;
+  // * Readers check the magic last
+  std::atomic_thread_fence(std::memory_order_release);
+  shared->magic = METRICS_MAGIC;
+
+  metrics = shared;
+  fprintf(stderr, "INFO: metrics: publishing to /dev/shm%s\n", metrics_shm_name);
+}
+
+void close_metrics() {
+  if (metrics == &private_metrics) return;
+  munmap(metrics, sizeof(Metrics));
+  shm_unlink(metrics_shm_name);
+  metrics = &private_metrics;
+}
+
+void record_frame_time(uint64_t frame_time) {
+  const size_t bucket = std::min<size_t>((size_t)std::bit_width(frame_time) - (frame_time > 0),
+                                         METRICS_FRAME_TIME_BUCKETS - 1);
+  metric_add(&metrics->frame_time_buckets[bucket]);
+  metric_set(&metrics->frame_time, frame_time);
+  metric_add(&metrics->frames_count);
+}
+
+void record_sim_tick_time(uint64_t tick_time) {
+  metric_set(&metrics->sim_tick_time, tick_time);
+  metric_add(&metrics->sim_tick_time_total, tick_time);
+  metric_add(&metrics->sim_ticks_count);
+}
+
+void record_projectile_pool_exhausted() {
+  if (metrics_resimulating) return;
+  metric_add(&metrics->projectile_pool_exhausted);
+}
+
+static inline
+uint64_t get_texture_bytes(SDL_Texture *texture) {
+  int w = 0, h = 0;
+  if (SDL_QueryTexture(texture, nullptr, nullptr, &w, &h) < 0) return 0;
+  return (uint64_t)w * (uint64_t)h * 4;
+}
+
+// * To be called by everyone creating or destroying a SDL_Texture
+void record_texture_created(SDL_Texture *texture) {
+  metric_add(&metrics->textures_count);
+  metric_add(&metrics->texture_bytes, get_texture_bytes(texture));
+}
+
+void record_texture_destroyed(SDL_Texture *texture) {
+  metric_sub(&metrics->textures_count, 1);
+  metric_sub(&metrics->texture_bytes, get_texture_bytes(texture));
+}
@@ -0,0 +1,213 @@
+// * ####################
+// * Particles
+// * ####################
+
+// * Short lived effects (impact poofs, sparks). Fixed capacity pool stored as
+// * structure of arrays with the live particles packed at the front, so
+// * updating is a handful of linear passes and rendering is one draw call.
+// * Purely visual: not part of the World and never snapshotted.
+
+const size_t PARTICLES_CAPACITY = 4096;
+
+enum class Particle_Kind : uint8_t {
+  Poof = 0, // * plays the impact animat
+  Spark     // * plain coloured square
+};
+
+struct Particle_Pool {
+  Vec2x pos[PARTICLES_CAPACITY];
+  Vec2x vel[PARTICLES_CAPACITY];
+  uint32_t age[PARTICLES_CAPACITY];      // * ms
+  uint32_t lifetime[PARTICLES_CAPACITY]; // * ms
+  int size[PARTICLES_CAPACITY];          // * side of the drawn square in pixels
+  Particle_Kind kind[PARTICLES_CAPACITY];
+  size_t count;
+
+  Fixed gravity;
+  Fixed drag; // * velocity kept every tick
+  uint32_t rng;
+  size_t dropped_count; // * spawns lost to a full pool
+};
+
+void init_particles(Particle_Pool *pool) {
+  assert(pool);
+  pool->count = 0;
+  pool->gravity = fixed_ratio(1, 4);
+  pool->drag = fixed_ratio(63, 64);
+  pool->rng = 0x2545f491;
+  pool->dropped_count = 0;
+}
+
+void spawn_particle(Particle_Pool *pool, Particle_Kind kind, Vec2x pos, Vec2x vel, uint32_t lifetime, int size) {
+  assert(pool);
+  if (pool->count == PARTICLES_CAPACITY) {
+    pool->dropped_count += 1;
+    metric_add(&metrics->particle_pool_exhausted);
+    return;
+  }
+
+  const size_t i = pool->count++;
+  pool->pos[i] = pos;
+  pool->vel[i] = vel;
+  pool->age[i] = 0;
+  pool->lifetime[i] = lifetime;
+  pool->size[i] = size;
+  pool->kind[i] = kind;
+}
+
+const uint32_t IMPACT_POOF_LIFETIME = 800;
+const int IMPACT_POOF_SIZE = 64;
+const size_t IMPACT_SPARKS_COUNT = 12;
+const uint32_t IMPACT_SPARK_LIFETIME = 400;
+const int IMPACT_SPARK_SIZE = 6;
+const SDL_Color IMPACT_SPARK_COLOR = {255, 214, 96, 255};
+
+// * Random fixed point number in [-range, range)
+static inline
+Fixed random_fixed(uint32_t *rng, int range) {
+  const uint32_t span = (uint32_t)(2 * range * FIXED_ONE);
+  return {(int32_t)(xorshift32(rng) % span) - range * FIXED_ONE};
+}
+
+// * One big poof plus a burst of sparks flying upward
+void spawn_impact_effect(Particle_Pool *pool, Vec2i pos) {
+  const Vec2x p = vec2_fixed(pos);
+  spawn_particle(pool, Particle_Kind::Poof, p, vec2(fixed(0), fixed(0)), IMPACT_POOF_LIFETIME, IMPACT_POOF_SIZE);
+
+  for (size_t i = 0; i < IMPACT_SPARKS_COUNT; ++i) {
+    const Fixed vx = random_fixed(&pool->rng, 4);
+    const Fixed vy = random_fixed(&pool->rng, 3) - fixed(3);
+    spawn_particle(pool, Particle_Kind::Spark, p, vec2(vx, vy), IMPACT_SPARK_LIFETIME, IMPACT_SPARK_SIZE);
+  }
+}
+
+void update_particles(Particle_Pool *pool, Uint64 dt) {
+  assert(pool);
+  const size_t n = pool->count;
+
+  // * Integrate everything in batches
+  for (size_t i = 0; i < n; ++i) {
+    pool->vel[i].y += pool->gravity;
+  }
+  vec2_scale_batch(pool->vel, pool->drag, n);
+  vec2_add_batch(pool->pos, pool->vel, n);
+
+  const uint32_t step = (uint32_t)std::min<Uint64>(dt, UINT32_MAX);
+  for (size_t i = 0; i < n; ++i) {
+    pool->age[i] += step;
+  }
+
+  // * Swap remove the expired particles to keep the live ones packed
+  for (size_t i = pool->count; i-- > 0; ) {
+    if (pool->age[i] >= pool->lifetime[i]) {
+      const size_t last = --pool->count;
+      pool->pos[i] = pool->pos[last];
+      pool->vel[i] = pool->vel[last];
+      pool->age[i] = pool->age[last];
+      pool->lifetime[i] = pool->lifetime[last];
+      pool->size[i] = pool->size[last];
+      pool->kind[i] = pool->kind[last];
+    }
+  }
+}
+
+// * The impact animat spritesheet with a row of white texels under it.
+// * Sparks sample the white row and get their colour from the vertices, so
+// * both kinds still go out in a single draw call.
+struct Particle_Atlas {
+  SDL_Texture *texture;
+  int width, height;
+  SDL_FPoint white; // * texture coordinates of a white texel
+};
+
+Particle_Atlas make_particle_atlas(SDL_Renderer *renderer, const Animat *animat) {
+  assert(animat);
+  SDL_Texture *sheet = animat->frames[0].texture;
+  int sheet_w = 0, sheet_h = 0;
+  sec(SDL_QueryTexture(sheet, nullptr, nullptr, &sheet_w, &sheet_h));
+
+  Particle_Atlas atlas = {};
+  atlas.width = sheet_w;
+  atlas.height = sheet_h + 1;
+  atlas.texture = sec(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                        SDL_TEXTUREACCESS_TARGET, atlas.width, atlas.height));
+  record_texture_created(atlas.texture);
+  sec(SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND));
+
+  // * Copy the sheet as is (alpha included) at the origin, so the frame
+  // * rects of the animat are valid in the atlas too
+  sec(SDL_SetRenderTarget(renderer, atlas.texture));
+  sec(SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0));
+  sec(SDL_RenderClear(renderer));
+  sec(SDL_SetTextureBlendMode(sheet, SDL_BLENDMODE_NONE));
+  const SDL_Rect sheet_rect = {0, 0, sheet_w, sheet_h};
+  sec(SDL_RenderCopy(renderer, sheet, &sheet_rect, &sheet_rect));
+  sec(SDL_SetTextureBlendMode(sheet, SDL_BLENDMODE_BLEND));
+
+  const SDL_Rect white_row = {0, sheet_h, sheet_w, 1};
+  sec(SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255));
+  sec(SDL_RenderFillRect(renderer, &white_row));
+  sec(SDL_SetRenderTarget(renderer, nullptr));
+
+  // * Centre of a texel, filtering does not blend in the sheet above
+  atlas.white = {0.5f / (float)atlas.width, ((float)sheet_h + 0.5f) / (float)atlas.height};
+  return atlas;
+}
+
+// * Draws every particle in a single SDL_RenderGeometry call: poofs with the
+// * frame of `animat` matching their age, sparks as plain squares. The
+// * geometry lives in the frame arena.
+void render_particles(SDL_Renderer *renderer,
+                      const Particle_Pool *pool,
+                      const Particle_Atlas *atlas,
+                      const Animat *animat)
+{
+  assert(pool);
+  assert(atlas);
+  assert(animat);
+  const size_t n = pool->count;
+  if (n == 0) return;
+
+  const float texture_w = (float)atlas->width, texture_h = (float)atlas->height;
+
+  SDL_Vertex *vertices = arena_alloc_array<SDL_Vertex>(&frame_arena, n * 4);
+  int *indices = arena_alloc_array<int>(&frame_arena, n * 6);
+
+  for (size_t i = 0; i < n; ++i) {
+    const Vec2i p = vec2_floor(pool->pos[i]);
+    const float half = (float)pool->size[i] * 0.5f;
+    const float x0 = (float)p.x - half, x1 = (float)p.x + half;
+    const float y0 = (float)p.y - half, y1 = (float)p.y + half;
+
+    // * Fade out over the lifetime
+    const Uint8 alpha = (Uint8)(255 - 255 * pool->age[i] / pool->lifetime[i]);
+
+    SDL_Color color = {255, 255, 255, alpha};
+    float u0 = atlas->white.x, u1 = atlas->white.x;
+    float v0 = atlas->white.y, v1 = atlas->white.y;
+    if (pool->kind[i] == Particle_Kind::Poof) {
+      const size_t frame = std::min<size_t>(
+          (size_t)pool->age[i] * animat->frames_count / pool->lifetime[i],
+          animat->frames_count - 1);
+      const SDL_Rect src = animat->frames[frame].rect;
+      u0 = (float)src.x / texture_w; u1 = (float)(src.x + src.w) / texture_w;
+      v0 = (float)src.y / texture_h; v1 = (float)(src.y + src.h) / texture_h;
+    } else {
+      color = IMPACT_SPARK_COLOR;
+      color.a = alpha;
+    }
+
+    SDL_Vertex *v = &vertices[i * 4];
+    v[0] = {{x0, y0}, color, {u0, v0}};
+    v[1] = {{x1, y0}, color, {u1, v0}};
+    v[2] = {{x1, y1}, color, {u1, v1}};
+    v[3] = {{x0, y1}, color, {u0, v1}};
+
+    const int base = (int)(i * 4);
+    int *quad = &indices[i * 6];
+    quad[0] = base + 0; quad[1] = base + 1; quad[2] = base + 2;
+    quad[3] = base + 0; quad[4] = base + 2; quad[5] = base + 3;
+  }
+
+  sec(SDL_RenderGeometry(renderer, atlas->texture, vertices, (int)(n * 4), indices, (int)(n * 6)));
+}
@@ -5,55 +5,64 @@
 
 enum class Projectile_State {
   Ded = 0,
-  Active,
-  Poof
+  Active
 };
 
 struct Projectile {
   Projectile_State state;
-  Vec2i pos;
-  Vec2i vel;
-  Animat poof_animat;
   Animat active_animat;
 };
 
 const size_t projectiles_count = 69;
-Projectile projectiles[projectiles_count] = {};
 
-void init_projectiles(Animat active_animat, Animat poof_animat) {
+struct Projectile_Pool {
+  Projectile projectiles[projectiles_count];
+  // * Positions & velocities live in their own arrays so that all the
+  // * projectiles are integrated in a single batch. Non active projectiles
+  // * keep a zero velocity.
+  Vec2i pos[projectiles_count];
+  Vec2i vel[projectiles_count];
+
+  // * Where projectiles hit something during the last update. The slot is
+  // * freed right away, the effect is left to whoever reads the impacts.
+  Vec2i impacts[projectiles_count];
+  size_t impacts_count;
+};
+
+void init_projectiles(Projectile_Pool *pool, Animat active_animat) {
+  assert(pool);
+  *pool = {};
   for (size_t i = 0; i < projectiles_count; ++i) {
-    projectiles[i].active_animat = active_animat;
-    projectiles[i].poof_animat = poof_animat;
+    pool->projectiles[i].active_animat = active_animat;
   }
 }
 
 
 // * Finds the first Ded projectile and spwans that
-void spwan_projectile(Vec2i pos, Vec2i vel) {
+void spwan_projectile(Projectile_Pool *pool, Vec2i pos, Vec2i vel) {
+  assert(pool);
+  Projectile *projectiles = pool->projectiles;
   for(size_t i = 0; i < projectiles_count; ++i) {
     if(projectiles[i].state == Projectile_State::Ded) {
       projectiles[i].state = Projectile_State::Active;
-      projectiles[i].pos = pos;
-      projectiles[i].vel = vel;
+      pool->pos[i] = pos;
+      pool->vel[i] = vel;
       return;
     }
   } 
+  record_projectile_pool_exhausted();
 }
 
 // * Renders all the active projectiles
-void render_projectiles(SDL_Renderer *renderer) {
+void render_projectiles(SDL_Renderer *renderer, const Projectile_Pool *pool) {
+  const Projectile *projectiles = pool->projectiles;
   for(size_t i = 0; i < projectiles_count; ++i) {
     switch (projectiles[i].state)
     {
       case Projectile_State::Active: { // * active animation
         render_animat(renderer,
                       projectiles[i].active_animat,
-                      projectiles[i].pos);
-      } break;
-      case Projectile_State::Poof: { // * poof animation;
-        render_animat(renderer,
-                      projectiles[i].poof_animat,
-                      projectiles[i].pos);
+                      pool->pos[i]);
       } break;
       case Projectile_State::Ded:
         break;
@@ -63,28 +72,29 @@ void render_projectiles(SDL_Renderer *renderer) {
   }
 }
 
-void update_projectiles(Uint64 dt) {
+void update_projectiles(Projectile_Pool *pool, const Level *level, Uint64 dt) {
+  assert(pool);
+  Projectile *projectiles = pool->projectiles;
+
+  pool->impacts_count = 0;
+
+  // * Update the projectile positions
+  vec2_add_batch(pool->pos, pool->vel, projectiles_count);
+
+  Vec2i tiles[projectiles_count];
+  vec2_floor_div_batch<TILE_SIZE>(tiles, pool->pos, projectiles_count);
+
   for(size_t i = 0; i < projectiles_count; ++i) {
     switch (projectiles[i].state)
     {
     case Projectile_State::Active: { // * update active animation
       update_animat(&projectiles[i].active_animat, dt);
 
-      // * Update the projectile position
-      if(projectiles[i].state != Projectile_State::Ded) {
-        projectiles[i].pos += projectiles[i].vel;
-      }
-
-      // * If projectile hit the tile then switch to poof animation
-      if(!is_tile_empty(projectiles[i].pos / TILE_SIZE) || !is_tile_inbounds(projectiles[i].pos / TILE_SIZE)) {
-        projectiles[i].state = Projectile_State::Poof; 
-        projectiles[i].poof_animat.frame_current = 0;
-      }
-    } break;
-    case Projectile_State::Poof: { // * poof animation
-      update_animat(&projectiles[i].poof_animat, dt);
-      if(projectiles[i].poof_animat.frame_current == projectiles[i].poof_animat.frames_count - 1) {
-        projectiles[i].state = Projectile_State::Ded;  
+      // * If projectile hit the tile then record the impact and free the slot
+      if(!is_tile_empty(level, tiles[i]) || !is_tile_inbounds(tiles[i])) {
+        projectiles[i].state = Projectile_State::Ded;
+        pool->vel[i] = vec2(0, 0);
+        pool->impacts[pool->impacts_count++] = pool->pos[i];
       }
     } break;
     default:
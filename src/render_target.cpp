@@ -0,0 +1,168 @@
+// * ####################
+// * Render Target
+// * ####################
+
+// * The world is drawn into an offscreen texture at a fixed internal
+// * resolution and the texture is scaled to the window, letterboxed. The
+// * window size does not change the fill cost. When rendering goes over
+// * budget only a smaller part of the texture is drawn (and stretched),
+// * which lowers the fill cost further.
+
+const int RENDER_SCALE_MAX = 100; // * percent of the internal resolution
+const int RENDER_SCALE_MIN = 50;
+const int RENDER_SCALE_STEP = 10;
+
+// * The render section (begin_render_target() through the blit) is measured
+// * on the CPU, the simulation and the vsync wait do not get cheaper with a
+// * lower resolution. It may use half of a display refresh, the rest is for
+// * the simulation & presenting. Going over the budget lowers the
+// * resolution, staying under RENDER_SCALE_UP_PERCENT of it raises it back,
+// * the gap keeps it from flipping every frame around the budget.
+// *
+// * The GPU fill is only paid in SDL_RenderPresent, where it can not be told
+// * apart from the vsync wait. A frame that took more than
+// * RENDER_MISSED_REFRESH_PERCENT of the refresh period from the previous
+// * present missed a refresh, so the whole interval is fed to the controller
+// * instead of the CPU time.
+const int RENDER_BUDGET_PERCENT = 50;          // * of the refresh period
+const int RENDER_SCALE_UP_PERCENT = 80;        // * of the render budget
+const int RENDER_MISSED_REFRESH_PERCENT = 150; // * of the refresh period
+const int DEFAULT_REFRESH_RATE = 60;           // * when the display does not say
+// * Frames to wait after a change for the average to settle
+const int RENDER_SCALE_COOLDOWN = 30;
+
+struct Render_Target {
+  SDL_Texture *texture;
+  int width, height; // * internal resolution
+
+  int scale; // * percent of the internal resolution drawn this frame
+
+  // * Where the target lands in the window
+  SDL_Rect viewport;
+
+  // * Dynamic resolution
+  uint64_t refresh_period;      // * us
+  uint64_t render_budget;       // * us
+  uint64_t render_time_average; // * us
+  uint64_t render_time;         // * us, CPU time of the last render section
+  Uint64 render_begin;          // * performance counter at begin_render_target()
+  Uint64 last_present;          // * performance counter after the last present, 0 before the first
+  size_t missed_refreshes_count;
+  int cooldown;
+};
+
+// * Render budget for a display refreshing `refresh_rate` times per second
+void set_render_refresh_rate(Render_Target *target, int refresh_rate) {
+  assert(target);
+  if (refresh_rate <= 0) refresh_rate = DEFAULT_REFRESH_RATE;
+  target->refresh_period = 1000000 / (uint64_t)refresh_rate;
+  target->render_budget = target->refresh_period * RENDER_BUDGET_PERCENT / 100;
+}
+
+Render_Target make_render_target(SDL_Renderer *renderer, int width, int height, int refresh_rate) {
+  assert(renderer);
+  Render_Target target = {};
+  target.texture = sec(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                         SDL_TEXTUREACCESS_TARGET, width, height));
+  record_texture_created(target.texture);
+  target.width = width;
+  target.height = height;
+  target.scale = RENDER_SCALE_MAX;
+  target.viewport = {0, 0, width, height};
+  set_render_refresh_rate(&target, refresh_rate);
+  return target;
+}
+
+// * Part of the texture in use at the current scale
+static inline
+SDL_Rect get_render_target_rect(const Render_Target *target) {
+  return {0, 0, target->width * target->scale / 100, target->height * target->scale / 100};
+}
+
+// * Everything drawn until end_render_target() goes into the target, in
+// * internal resolution coordinates
+void begin_render_target(SDL_Renderer *renderer, Render_Target *target) {
+  assert(target);
+  target->render_begin = SDL_GetPerformanceCounter();
+  sec(SDL_SetRenderTarget(renderer, target->texture));
+  sec(SDL_RenderClear(renderer));
+  const float scale = (float)target->scale / 100.0f;
+  sec(SDL_RenderSetScale(renderer, scale, scale));
+}
+
+// * Feeds the cost of the last frame to the dynamic resolution controller
+void update_render_scale(Render_Target *target, uint64_t render_time) {
+  assert(target);
+  // * Exponential moving average over ~8 frames, a single hitch does not count
+  target->render_time_average = target->render_time_average - target->render_time_average / 8 + render_time / 8;
+
+  if (target->cooldown > 0) {
+    target->cooldown -= 1;
+    return;
+  }
+
+  int scale = target->scale;
+  if (target->render_time_average > target->render_budget) {
+    scale = std::max(scale - RENDER_SCALE_STEP, RENDER_SCALE_MIN);
+  } else if (target->render_time_average < target->render_budget * RENDER_SCALE_UP_PERCENT / 100) {
+    scale = std::min(scale + RENDER_SCALE_STEP, RENDER_SCALE_MAX);
+  }
+
+  if (scale != target->scale) {
+    target->scale = scale;
+    target->cooldown = RENDER_SCALE_COOLDOWN;
+  }
+}
+
+// * Back to the window and stretch the target over it, keeping the aspect ratio
+void end_render_target(SDL_Renderer *renderer, Render_Target *target) {
+  assert(target);
+  sec(SDL_SetRenderTarget(renderer, nullptr));
+
+  int window_w = 0, window_h = 0;
+  sec(SDL_GetRendererOutputSize(renderer, &window_w, &window_h));
+  if ((int64_t)window_w * target->height > (int64_t)window_h * target->width) {
+    // * Wider than the target, bars on the sides
+    const int w = (int)((int64_t)window_h * target->width / target->height);
+    target->viewport = {(window_w - w) / 2, 0, w, window_h};
+  } else {
+    const int h = (int)((int64_t)window_w * target->height / target->width);
+    target->viewport = {0, (window_h - h) / 2, window_w, h};
+  }
+
+  const SDL_Rect src = get_render_target_rect(target);
+  sec(SDL_RenderClear(renderer));
+  sec(SDL_RenderCopy(renderer, target->texture, &src, &target->viewport));
+
+  target->render_time = (SDL_GetPerformanceCounter() - target->render_begin) * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+// * Presents the frame and updates the scale with the render time, or with
+// * the whole frame interval when the frame missed a refresh
+void present_render_target(SDL_Renderer *renderer, Render_Target *target) {
+  assert(target);
+  SDL_RenderPresent(renderer);
+
+  const Uint64 now = SDL_GetPerformanceCounter();
+  uint64_t cost = target->render_time;
+  if (target->last_present != 0) {
+    const uint64_t interval = (now - target->last_present) * 1000000 / SDL_GetPerformanceFrequency();
+    if (interval > target->refresh_period * RENDER_MISSED_REFRESH_PERCENT / 100) {
+      target->missed_refreshes_count += 1;
+      // * Capped so that a long stall (window drag, ...) does not hold the
+      // * average up for seconds
+      cost = std::max(cost, std::min(interval, 2 * target->refresh_period));
+    }
+  }
+  target->last_present = now;
+  update_render_scale(target, cost);
+}
+
+// * Window coordinates (mouse, ...) to internal resolution coordinates
+Vec2i window_to_render_target(const Render_Target *target, Vec2i p) {
+  assert(target);
+  const SDL_Rect v = target->viewport;
+  if (v.w <= 0 || v.h <= 0) return p;
+  return vec2((int)((int64_t)(p.x - v.x) * target->width / v.w),
+              (int)((int64_t)(p.y - v.y) * target->height / v.h));
+}
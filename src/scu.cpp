@@ -4,16 +4,48 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstddef>
+#include <cstring>
 #include <algorithm>
+#include <bit>
+#include <atomic>
+#include <thread>
+#include <coroutine>
+#include <utility>
+#include <new>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <signal.h>
 #include <png.h>
 #include <cassert>
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <SDL.h>
 #include <SDL_ttf.h>
 
 #include "error.cpp"
+#include "arena.cpp"
+#include "metrics.cpp"
 #include "vec2.cpp"
 #include "sprite.cpp"
 #include "level.cpp"
 #include "projectile.cpp"
+#include "flow_field.cpp"
+#include "line_of_sight.cpp"
 #include "entity.cpp"
-#include "main.cpp"
\ No newline at end of file
+#include "world.cpp"
+#include "behaviour.cpp"
+#include "world_batch.cpp"
+#include "particle.cpp"
+#include "snapshot.cpp"
+#include "render_target.cpp"
+#include "input.cpp"
+// * bench.cpp brings its own main()
+#ifndef SCU_NO_MAIN
+#include "main.cpp"
+#endif
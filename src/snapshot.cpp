@@ -0,0 +1,257 @@
+// * ####################
+// * Snapshot
+// * ####################
+
+// * Copies of the mutable simulation state only: no sprites, boxes or
+// * derived data (autotile, flow field), which are either shared or
+// * recomputed. Everything lives in fixed arrays, saving & restoring never
+// * allocates.
+
+struct Animat_Cursor {
+  size_t frame_current;
+  uint64_t frame_cooldown;
+};
+
+static inline
+Animat_Cursor get_animat_cursor(const Animat *animat) {
+  return {animat->frame_current, animat->frame_cooldown};
+}
+
+static inline
+void set_animat_cursor(Animat *animat, Animat_Cursor cursor) {
+  animat->frame_current = cursor.frame_current;
+  animat->frame_cooldown = cursor.frame_cooldown;
+}
+
+struct Entity_Snapshot {
+  Vec2x pos;
+  Vec2x vel;
+  Entity_Dir dir;
+  Entity_Animat current;
+  int weapon_cooldown;
+  Animat_Cursor idle;
+  Animat_Cursor walking;
+};
+
+struct Projectile_Snapshot {
+  Projectile_State state;
+  Animat_Cursor active;
+};
+
+struct World_Snapshot {
+  bool valid;
+
+  // * The tiles are not copied into every snapshot, snapshots of the same
+  // * level revision share one tile page of the store
+  uint32_t level_revision;
+  size_t tile_page;
+
+  size_t entities_count;
+  Entity_Snapshot entities[entity_count];
+
+  Projectile_Snapshot projectiles[projectiles_count];
+  Vec2i projectiles_pos[projectiles_count];
+  Vec2i projectiles_vel[projectiles_count];
+
+  size_t player_falls_count;
+};
+
+struct Tile_Page {
+  uint32_t revision;
+  uint32_t refs; // * snapshots using this page
+  Tile tiles[LEVEL_HEIGHT][LEVEL_WIDTH];
+};
+
+// * N snapshots of ONE world. At most N distinct tile maps can be referenced,
+// * so N tile pages always suffice.
+template <size_t N>
+struct Snapshot_Store {
+  World_Snapshot snapshots[N];
+  Tile_Page tile_pages[N];
+};
+
+template <size_t N>
+void release_tile_page(Snapshot_Store<N> *store, World_Snapshot *snapshot) {
+  if (!snapshot->valid) return;
+  Tile_Page *page = &store->tile_pages[snapshot->tile_page];
+  assert(page->refs > 0);
+  page->refs -= 1;
+}
+
+// * Finds the page holding the level's current tiles or copies them into a free one
+template <size_t N>
+size_t acquire_tile_page(Snapshot_Store<N> *store, const Level *level) {
+  size_t free_page = N;
+  for (size_t i = 0; i < N; ++i) {
+    Tile_Page *page = &store->tile_pages[i];
+    if (page->refs > 0 && page->revision == level->revision) {
+      page->refs += 1;
+      return i;
+    }
+    if (page->refs == 0 && free_page == N) {
+      free_page = i;
+    }
+  }
+
+  assert(free_page < N);
+  Tile_Page *page = &store->tile_pages[free_page];
+  page->revision = level->revision;
+  page->refs = 1;
+  memcpy(page->tiles, level->tiles, sizeof(page->tiles));
+  return free_page;
+}
+
+template <size_t N>
+void save_snapshot(Snapshot_Store<N> *store, size_t slot, const World *world) {
+  assert(store);
+  assert(world);
+  assert(slot < N);
+
+  World_Snapshot *snapshot = &store->snapshots[slot];
+  release_tile_page(store, snapshot);
+  snapshot->tile_page = acquire_tile_page(store, &world->level);
+  snapshot->level_revision = world->level.revision;
+
+  snapshot->entities_count = world->entities_count;
+  for (size_t i = 0; i < world->entities_count; ++i) {
+    const Entity *entity = &world->entities[i];
+    snapshot->entities[i] = {
+      .pos = entity->pos,
+      .vel = entity->vel,
+      .dir = entity->dir,
+      .current = entity->current,
+      .weapon_cooldown = entity->weapon_cooldown,
+      .idle = get_animat_cursor(&entity->idle),
+      .walking = get_animat_cursor(&entity->walking),
+    };
+  }
+
+  const Projectile_Pool *pool = &world->projectiles;
+  for (size_t i = 0; i < projectiles_count; ++i) {
+    snapshot->projectiles[i] = {
+      .state = pool->projectiles[i].state,
+      .active = get_animat_cursor(&pool->projectiles[i].active_animat),
+    };
+  }
+  memcpy(snapshot->projectiles_pos, pool->pos, sizeof(pool->pos));
+  memcpy(snapshot->projectiles_vel, pool->vel, sizeof(pool->vel));
+
+  snapshot->player_falls_count = world->player_falls_count;
+  snapshot->valid = true;
+}
+
+template <size_t N>
+bool is_snapshot_valid(const Snapshot_Store<N> *store, size_t slot) {
+  assert(slot < N);
+  return store->snapshots[slot].valid;
+}
+
+// * Entities are only restored into slots that were spawned already, so the
+// * world must not have lost entities since the snapshot was taken.
+template <size_t N>
+void restore_snapshot(const Snapshot_Store<N> *store, size_t slot, World *world) {
+  assert(store);
+  assert(world);
+  assert(is_snapshot_valid(store, slot));
+
+  const World_Snapshot *snapshot = &store->snapshots[slot];
+
+  // * Copy the tiles only when they changed since the snapshot
+  Level *level = &world->level;
+  if (level->revision != snapshot->level_revision) {
+    memcpy(level->tiles, store->tile_pages[snapshot->tile_page].tiles, sizeof(level->tiles));
+    level->revision = snapshot->level_revision;
+    // * Subscribers recompute everything on the next flush
+    level->dirty_rects_count = 0;
+    mark_level_dirty(level, {0, 0, LEVEL_WIDTH, LEVEL_HEIGHT});
+  }
+
+  assert(snapshot->entities_count <= world->entities_count);
+  world->entities_count = snapshot->entities_count;
+  for (size_t i = 0; i < snapshot->entities_count; ++i) {
+    const Entity_Snapshot *s = &snapshot->entities[i];
+    Entity *entity = &world->entities[i];
+    entity->pos = s->pos;
+    entity->vel = s->vel;
+    entity->dir = s->dir;
+    entity->current = s->current;
+    entity->weapon_cooldown = s->weapon_cooldown;
+    set_animat_cursor(&entity->idle, s->idle);
+    set_animat_cursor(&entity->walking, s->walking);
+  }
+
+  Projectile_Pool *pool = &world->projectiles;
+  for (size_t i = 0; i < projectiles_count; ++i) {
+    pool->projectiles[i].state = snapshot->projectiles[i].state;
+    set_animat_cursor(&pool->projectiles[i].active_animat, snapshot->projectiles[i].active);
+  }
+  memcpy(pool->pos, snapshot->projectiles_pos, sizeof(pool->pos));
+  memcpy(pool->vel, snapshot->projectiles_vel, sizeof(pool->vel));
+
+  world->player_falls_count = snapshot->player_falls_count;
+}
+
+// * ####################
+// * Rollback
+// * ####################
+
+// * Keeps the state before each of the last ROLLBACK_TICKS ticks together with
+// * the input & dt of the tick, so the world can be rewound and simulated
+// * forward again once late (or corrected) input arrives.
+
+const size_t ROLLBACK_TICKS = 16;
+
+struct Rollback {
+  Snapshot_Store<ROLLBACK_TICKS> store;
+  Tick_Input inputs[ROLLBACK_TICKS];
+  Uint64 dts[ROLLBACK_TICKS];
+  uint64_t tick; // * ticks simulated so far
+};
+
+// * Saves the state, records the input and simulates one tick
+void rollback_step(Rollback *rollback, World *world, const Tick_Input *input, Uint64 dt) {
+  assert(rollback);
+  const size_t slot = rollback->tick % ROLLBACK_TICKS;
+  save_snapshot(&rollback->store, slot, world);
+  rollback->inputs[slot] = *input;
+  rollback->dts[slot] = dt;
+
+  apply_tick_input(world, input);
+  world_step(world, dt);
+  rollback->tick += 1;
+}
+
+// * Forgets the recorded ticks. Call it after changing the world outside of
+// * the rollback (quick load, ...), re-simulating from a snapshot taken
+// * before the change would silently undo it.
+void rollback_reset(Rollback *rollback) {
+  assert(rollback);
+  rollback->tick = 0;
+}
+
+// * Recorded input of a past tick, to be corrected before rollback_resimulate()
+Tick_Input *get_rollback_input(Rollback *rollback, uint64_t tick) {
+  assert(rollback);
+  assert(tick < rollback->tick && rollback->tick - tick <= ROLLBACK_TICKS);
+  return &rollback->inputs[tick % ROLLBACK_TICKS];
+}
+
+// * Rewinds the world `ticks_back` ticks and simulates them again with the
+// * recorded inputs
+void rollback_resimulate(Rollback *rollback, World *world, size_t ticks_back) {
+  assert(rollback);
+  assert(ticks_back <= ROLLBACK_TICKS && ticks_back <= rollback->tick);
+  if (ticks_back == 0) return;
+
+  const uint64_t end = rollback->tick;
+  rollback->tick -= ticks_back;
+  restore_snapshot(&rollback->store, rollback->tick % ROLLBACK_TICKS, world);
+
+  metrics_resimulating = true;
+  while (rollback->tick < end) {
+    const size_t slot = rollback->tick % ROLLBACK_TICKS;
+    const Tick_Input input = rollback->inputs[slot];
+    rollback_step(rollback, world, &input, rollback->dts[slot]);
+  }
+  metrics_resimulating = false;
+}
@@ -108,7 +108,7 @@ SDL_Texture *load_texture_from_png(SDL_Renderer *renderer, const char *filepath)
   * height and format) stored in 'image'.
   */
   png_bytep image_pixels;
-  image_pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
+  image_pixels = (png_bytep)arena_alloc(&scratch_arena, PNG_IMAGE_SIZE(image));
 
   if (!png_image_finish_read(
           &image,
@@ -136,9 +136,11 @@ SDL_Texture *load_texture_from_png(SDL_Renderer *renderer, const char *filepath)
   // * This is a sdl texture from sdl surface
   SDL_Texture *image_texture =
       sec(SDL_CreateTextureFromSurface(renderer, image_surface));
+  record_texture_created(image_texture);
 
-  free(image_pixels);
   SDL_FreeSurface(image_surface);
+  // * Pixels are uploaded to the texture, the scratch memory is free to reuse
+  arena_reset(&scratch_arena);
   return image_texture;
 }
 
@@ -149,7 +151,7 @@ Animat load_spritesheet_animat(SDL_Renderer *renderer,
                                const char *spritsheet_filepath)
 {
   Animat result = {
-    .frames = new Sprite[frame_count],
+    .frames = arena_alloc_array<Sprite>(&asset_arena, frame_count),
     .frames_count = frame_count,
     .frame_duration = frame_duration
   };
@@ -15,6 +15,67 @@ Vec2<T> vec2(T x, T y) {
 // * integer alias
 using Vec2i = Vec2<int>;
 
+// * /////////////////////////////////////////
+// * Fixed point (Q24.8)
+// * /////////////////////////////////////////
+
+const int FIXED_SHIFT = 8;
+const int32_t FIXED_ONE = 1 << FIXED_SHIFT;
+
+// * Integer backed number with FIXED_SHIFT fractional bits. Gives sub-pixel
+// * precision while staying bit-for-bit deterministic across machines.
+struct Fixed {
+  int32_t raw;
+};
+
+constexpr Fixed fixed(int x) {
+  return {x * FIXED_ONE};
+}
+
+// * `num / den` pixels, e.g. fixed_ratio(1, 2) is half a pixel
+constexpr Fixed fixed_ratio(int num, int den) {
+  return {(int32_t)(((int64_t)num * FIXED_ONE) / den)};
+}
+
+// * Rounds toward negative infinity
+constexpr int fixed_floor(Fixed a) {
+  return a.raw >> FIXED_SHIFT;
+}
+
+constexpr Fixed operator+(Fixed a, Fixed b) { return {a.raw + b.raw}; }
+constexpr Fixed operator-(Fixed a, Fixed b) { return {a.raw - b.raw}; }
+constexpr Fixed operator-(Fixed a) { return {-a.raw}; }
+
+constexpr Fixed operator*(Fixed a, Fixed b) {
+  return {(int32_t)(((int64_t)a.raw * b.raw) >> FIXED_SHIFT)};
+}
+
+constexpr Fixed operator/(Fixed a, Fixed b) {
+  return {(int32_t)(((int64_t)a.raw * FIXED_ONE) / b.raw)};
+}
+
+constexpr Fixed &operator+=(Fixed &a, Fixed b) { a = a + b; return a; }
+
+constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+// * fixed point alias
+using Vec2x = Vec2<Fixed>;
+
+static inline
+Vec2x vec2_fixed(Vec2i a) {
+  return {fixed(a.x), fixed(a.y)};
+}
+
+static inline
+Vec2i vec2_floor(Vec2x a) {
+  return {fixed_floor(a.x), fixed_floor(a.y)};
+}
+
 // * /////////////////////////////////////////
 // * Scalar Multiplication (Vec2 x Vec2)
 // * /////////////////////////////////////////
@@ -39,6 +100,44 @@ Vec2<T> operator/(Vec2<T> a, Vec2<T> b) {
   return {a.x / b.x, a.y / b.y};
 }
 
+// * /////////////////////////////////////////
+// * Floor division by a compile time constant
+// * /////////////////////////////////////////
+
+// * Rounds toward negative infinity (plain `/` rounds toward zero, which maps
+// * -N+1..-1 onto 0). Power of two divisors compile down to a shift.
+template <int N>
+constexpr int floor_div(int a) {
+  static_assert(N > 0, "floor_div: divisor must be positive");
+  if constexpr ((N & (N - 1)) == 0) {
+    return a >> std::countr_zero((unsigned)N);
+  } else {
+    const int q = a / N;
+    return (a % N < 0) ? q - 1 : q;
+  }
+}
+
+// * Always in [0, N). Power of two divisors compile down to a mask.
+template <int N>
+constexpr int floor_mod(int a) {
+  static_assert(N > 0, "floor_mod: divisor must be positive");
+  if constexpr ((N & (N - 1)) == 0) {
+    return a & (N - 1);
+  } else {
+    return a - floor_div<N>(a) * N;
+  }
+}
+
+template <int N>
+constexpr Vec2i floor_div(Vec2i a) {
+  return {floor_div<N>(a.x), floor_div<N>(a.y)};
+}
+
+template <int N>
+constexpr Vec2i floor_mod(Vec2i a) {
+  return {floor_mod<N>(a.x), floor_mod<N>(a.y)};
+}
+
 static inline
 int get_sqr_dist(Vec2i p0, Vec2i p1) {
   auto d = p0 - p1;
@@ -96,4 +195,116 @@ Vec2<T> operator/(T a, Vec2<T> b) {
   return {a / b.x, a / b.y};
 }
 
+// * /////////////////////////////////////////
+// * Batch operations (over spans of Vec2)
+// * /////////////////////////////////////////
+
+// * Vec2i and Vec2x are both pairs of 32 bit integers, so the additive
+// * kernels below work on them as flat int32 arrays of 2 * count lanes.
+static_assert(sizeof(Vec2i) == 2 * sizeof(int32_t));
+static_assert(sizeof(Vec2x) == 2 * sizeof(int32_t));
+
+static inline
+void add_i32_batch(int32_t *dst, const int32_t *src, size_t lanes) {
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= lanes; i += 4) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+    const __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(a, b));
+  }
+#endif
+  for (; i < lanes; ++i) {
+    dst[i] += src[i];
+  }
+}
+
+// * dst[i] += src[i]
+void vec2_add_batch(Vec2i *dst, const Vec2i *src, size_t count) {
+  add_i32_batch((int32_t*)dst, (const int32_t*)src, count * 2);
+}
+
+// * dst[i] += src[i]
+void vec2_add_batch(Vec2x *dst, const Vec2x *src, size_t count) {
+  add_i32_batch((int32_t*)dst, (const int32_t*)src, count * 2);
+}
+
+#ifdef __SSE2__
+// * Low 32 bits of the lane products. _mm_mullo_epi32 is SSE4.1, but the low
+// * half of a product is the same signed or unsigned, so _mm_mul_epu32 over
+// * the even and the odd lanes does it.
+static inline
+__m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+// * dst[i] = dst[i] * s
+void vec2_scale_batch(Vec2i *dst, int s, size_t count) {
+  int32_t *lanes = (int32_t*)dst;
+  const size_t lanes_count = count * 2;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i k = _mm_set1_epi32(s);
+  for (; i + 4 <= lanes_count; i += 4) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)(lanes + i));
+    _mm_storeu_si128((__m128i*)(lanes + i), mullo_epi32_sse2(a, k));
+  }
+#endif
+  for (; i < lanes_count; ++i) {
+    lanes[i] *= s;
+  }
+}
+
+// * Scales up to this are exact in the batch kernel below
+const int32_t FIXED_SCALE_BATCH_MAX = 1 << 23;
+
+// * dst[i] = dst[i] * s, bit for bit the same as the scalar operator*. Each
+// * lane is split into a = hi * FIXED_ONE + lo with lo in [0, FIXED_ONE), then
+// * a * s >> FIXED_SHIFT == hi * s + (lo * s >> FIXED_SHIFT), which only needs
+// * 32 bit products.
+void vec2_scale_batch(Vec2x *dst, Fixed s, size_t count) {
+  assert(-FIXED_SCALE_BATCH_MAX < s.raw && s.raw < FIXED_SCALE_BATCH_MAX);
+  int32_t *lanes = (int32_t*)dst;
+  const size_t lanes_count = count * 2;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i k = _mm_set1_epi32(s.raw);
+  const __m128i lo_mask = _mm_set1_epi32(FIXED_ONE - 1);
+  for (; i + 4 <= lanes_count; i += 4) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)(lanes + i));
+    const __m128i hi = mullo_epi32_sse2(_mm_srai_epi32(a, FIXED_SHIFT), k);
+    const __m128i lo = _mm_srai_epi32(mullo_epi32_sse2(_mm_and_si128(a, lo_mask), k), FIXED_SHIFT);
+    _mm_storeu_si128((__m128i*)(lanes + i), _mm_add_epi32(hi, lo));
+  }
+#endif
+  for (; i < lanes_count; ++i) {
+    lanes[i] = (Fixed{lanes[i]} * s).raw;
+  }
+}
+
+// * dst[i] = floor_div<N>(src[i]), e.g. pixel positions into tile positions
+template <int N>
+void vec2_floor_div_batch(Vec2i *dst, const Vec2i *src, size_t count) {
+  const int32_t *src_lanes = (const int32_t*)src;
+  int32_t *dst_lanes = (int32_t*)dst;
+  const size_t lanes_count = count * 2;
+  size_t i = 0;
+#ifdef __SSE2__
+  if constexpr ((N & (N - 1)) == 0) {
+    const int shift = std::countr_zero((unsigned)N);
+    for (; i + 4 <= lanes_count; i += 4) {
+      const __m128i a = _mm_loadu_si128((const __m128i*)(src_lanes + i));
+      _mm_storeu_si128((__m128i*)(dst_lanes + i), _mm_srai_epi32(a, shift));
+    }
+  }
+#endif
+  for (; i < lanes_count; ++i) {
+    dst_lanes[i] = floor_div<N>(src_lanes[i]);
+  }
+}
+
 #endif // * VEC_HPP_
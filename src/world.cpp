@@ -0,0 +1,323 @@
+// * ####################
+// * World
+// * ####################
+
+// * Everything a single simulation owns. Worlds are plain data that do not
+// * share any mutable state with each other or with the renderer, so any
+// * number of them can be stepped in one process.
+
+const size_t PLAYER_ENTITY = 0;
+const int PLAYER_SPEED = 2;
+const int ENEMY_SPEED = 1;
+// * Centre of the first column: x = 0 would leave half of the hitbox in
+// * tile -1, outside of the level, where nothing is solid
+const Vec2i PLAYER_SPAWN = {TILE_SIZE / 2, 0};
+
+// * Read only data shared by all the worlds. The animat frames live in the
+// * asset arena (or are null when running headless).
+struct World_Assets {
+  SDL_Rect texbox;
+  SDL_Rect hitbox;
+  Animat idle;
+  Animat walking;
+  Animat projectile_active;
+};
+
+const int PLAYER_TEXBOX_SIZE = 48;
+const int PLAYER_HITBOX_SIZE = (PLAYER_TEXBOX_SIZE - 10);
+
+// * Animat layout of the spritesheets
+const size_t WALKING_FRAME_COUNT = 4;
+const uint32_t WALKING_FRAME_DURATION = 100;
+const size_t PLASMA_POP_FRAME_COUNT = 5;
+const uint32_t PLASMA_POP_FRAME_DURATION = 200;
+const size_t PLASMA_POOF_FRAME_COUNT = 4;
+const uint32_t PLASMA_POOF_FRAME_DURATION = 200;
+
+void init_entity_boxes(World_Assets *assets) {
+  assets->texbox = {
+      -(PLAYER_TEXBOX_SIZE / 2), -(PLAYER_TEXBOX_SIZE / 2), PLAYER_TEXBOX_SIZE, PLAYER_TEXBOX_SIZE};
+
+  assets->hitbox = {
+      -(PLAYER_HITBOX_SIZE / 2), -(PLAYER_HITBOX_SIZE / 2), PLAYER_HITBOX_SIZE - 10, PLAYER_HITBOX_SIZE};
+}
+
+// * Same timings as load_world_assets() but without any frames to render
+World_Assets headless_world_assets() {
+  World_Assets assets = {};
+  init_entity_boxes(&assets);
+  assets.walking = {nullptr, WALKING_FRAME_COUNT, 0, WALKING_FRAME_DURATION, 0};
+  assets.idle = {nullptr, 1, 0, 100, 0};
+  assets.projectile_active = {nullptr, PLASMA_POP_FRAME_COUNT, 0, PLASMA_POP_FRAME_DURATION, 0};
+  return assets;
+}
+
+struct World {
+  Level level;
+  Flow_Field flow_field;
+  Line_Of_Sight_Cache line_of_sight;
+  Projectile_Pool projectiles;
+
+  // * entities[PLAYER_ENTITY] is the player, the rest are enemies
+  Entity entities[entity_count];
+  size_t entities_count;
+
+  Vec2x gravity;
+
+  size_t player_falls_count; // * times the player fell out of the level
+};
+
+// * ####################
+// * Level edit subscribers
+// * ####################
+
+// * Called with a dirty region of the world's level in tile coordinates
+typedef void (*Level_Edit_Callback)(World *world, SDL_Rect dirty);
+
+void world_update_autotile(World *world, SDL_Rect dirty) {
+  update_level_autotile(&world->level, dirty);
+}
+
+void world_invalidate_flow_field(World *world, SDL_Rect) {
+  world->flow_field.dirty = true;
+}
+
+void world_invalidate_line_of_sight(World *world, SDL_Rect dirty) {
+  invalidate_line_of_sight(&world->line_of_sight, dirty);
+}
+
+const size_t LEVEL_EDIT_SUBSCRIBERS_CAPACITY = 8;
+Level_Edit_Callback level_edit_subscribers[LEVEL_EDIT_SUBSCRIBERS_CAPACITY] = {
+  world_update_autotile,
+  world_invalidate_flow_field,
+  world_invalidate_line_of_sight,
+};
+size_t level_edit_subscribers_count = 3;
+
+// * The subscribers are shared by all the worlds, so subscribe before any
+// * world is stepped (and never while a batch is running).
+void subscribe_level_edits(Level_Edit_Callback callback) {
+  assert(callback);
+  assert(level_edit_subscribers_count < LEVEL_EDIT_SUBSCRIBERS_CAPACITY);
+  level_edit_subscribers[level_edit_subscribers_count++] = callback;
+}
+
+// * Notifies the subscribers about the regions edited since the last flush
+void flush_level_edits(World *world) {
+  assert(world);
+  Level *level = &world->level;
+  for (size_t i = 0; i < level->dirty_rects_count; ++i) {
+    for (size_t j = 0; j < level_edit_subscribers_count; ++j) {
+      level_edit_subscribers[j](world, level->dirty_rects[i]);
+    }
+  }
+  level->dirty_rects_count = 0;
+}
+
+// * ####################
+// * World lifetime
+// * ####################
+
+Entity *spawn_entity(World *world, const World_Assets *assets, Vec2i pos) {
+  assert(world);
+  assert(assets);
+  assert(world->entities_count < entity_count);
+
+  Entity *entity = &world->entities[world->entities_count++];
+  *entity = {};
+  entity->texbox = assets->texbox;
+  entity->hitbox = assets->hitbox;
+  entity->idle = assets->idle;
+  entity->walking = assets->walking;
+  entity->current = Entity_Animat::Idle;
+  entity->pos = vec2_fixed(pos);
+  entity->spawn = pos;
+  return entity;
+}
+
+static inline
+Entity *get_player(World *world) {
+  return &world->entities[PLAYER_ENTITY];
+}
+
+static inline
+Vec2i get_player_tile(const World *world) {
+  return world_to_tile(vec2_floor(world->entities[PLAYER_ENTITY].pos));
+}
+
+void init_world(World *world, const World_Assets *assets) {
+  assert(world);
+  assert(assets);
+
+  *world = {};
+  init_level(&world->level, default_level);
+  init_projectiles(&world->projectiles, assets->projectile_active);
+  world->gravity = vec2(fixed(0), fixed(1));
+
+  spawn_entity(world, assets, PLAYER_SPAWN); // * Player
+  spawn_entity(world, assets, vec2(100, 0)); // * Enemy
+
+  // * Enemies chase the player through the flow field
+  compute_flow_field(&world->flow_field, &world->level, get_player_tile(world));
+}
+
+// * Advances the simulation by one tick. The player is driven from outside
+// * (keyboard, bot, ...) before the step.
+void world_step(World *world, Uint64 dt) {
+  assert(world);
+
+  // * Let everyone who caches level data catch up with the edits
+  flush_level_edits(world);
+
+  update_flow_field(&world->flow_field, &world->level, get_player_tile(world));
+
+  // * Enemies only shoot at a player they can see
+  const Vec2i player_pos = vec2_floor(world->entities[PLAYER_ENTITY].pos);
+  Line_Of_Sight_Query queries[entity_count];
+  bool visible[entity_count];
+  for (size_t i = PLAYER_ENTITY + 1; i < world->entities_count; ++i) {
+    queries[i] = {vec2_floor(world->entities[i].pos), player_pos};
+  }
+  query_line_of_sight(&world->line_of_sight, &world->level,
+                      queries + PLAYER_ENTITY + 1, visible + PLAYER_ENTITY + 1,
+                      world->entities_count - (PLAYER_ENTITY + 1));
+
+  for (size_t i = PLAYER_ENTITY + 1; i < world->entities_count; ++i) {
+    if (world->entities[i].scripted) continue;
+    entity_follow_flow_field(&world->level, &world->entities[i], &world->flow_field, ENEMY_SPEED);
+    if (visible[i]) {
+      entity_shoot(&world->entities[i], &world->projectiles);
+    }
+  }
+
+  for (size_t i = 0; i < world->entities_count; ++i) {
+    Entity *entity = &world->entities[i];
+    update_entity(&world->level, entity, world->gravity, dt);
+    if (has_entity_fallen_out(entity)) {
+      respawn_entity(entity);
+      world->player_falls_count += i == PLAYER_ENTITY;
+    }
+  }
+  update_projectiles(&world->projectiles, &world->level, dt);
+}
+
+// * ####################
+// * World input
+// * ####################
+
+// * What the player asks for during one tick
+struct Player_Input {
+  int move; // * < 0 left, > 0 right, 0 stop
+  bool jump;
+  bool shoot;
+  bool respawn;
+};
+
+struct Tile_Edit {
+  Vec2i tile;
+  Tile value;
+};
+
+const size_t TICK_TILE_EDITS_CAPACITY = 32;
+
+// * Orders for non player entities, given by behaviour scripts
+enum class Entity_Order : uint8_t {
+  Move_Left,
+  Move_Right,
+  Stop,
+  Jump,
+  Shoot
+};
+
+struct Entity_Command {
+  size_t entity;
+  Entity_Order order;
+};
+
+const size_t TICK_COMMANDS_CAPACITY = 64;
+
+// * Everything from outside that affects one tick of a world. Applying the
+// * same inputs to the same state always gives the same result, which is
+// * what rollback re-simulation relies on.
+struct Tick_Input {
+  Player_Input player;
+  Tile_Edit tile_edits[TICK_TILE_EDITS_CAPACITY];
+  size_t tile_edits_count;
+  Entity_Command commands[TICK_COMMANDS_CAPACITY];
+  size_t commands_count;
+};
+
+// * Records a tile edit. Repeating the previous edit is ignored, edits past
+// * the capacity are dropped.
+void push_tile_edit(Tick_Input *input, Vec2i tile, Tile value) {
+  assert(input);
+  if (input->tile_edits_count > 0) {
+    const Tile_Edit last = input->tile_edits[input->tile_edits_count - 1];
+    if (last.tile.x == tile.x && last.tile.y == tile.y && last.value == value) return;
+  }
+  if (input->tile_edits_count < TICK_TILE_EDITS_CAPACITY) {
+    input->tile_edits[input->tile_edits_count++] = {tile, value};
+  }
+}
+
+// * Orders past the capacity are dropped
+void push_entity_command(Tick_Input *input, size_t entity, Entity_Order order) {
+  assert(input);
+  if (input->commands_count < TICK_COMMANDS_CAPACITY) {
+    input->commands[input->commands_count++] = {entity, order};
+  }
+}
+
+void apply_entity_command(World *world, Entity_Command command) {
+  assert(command.entity < world->entities_count);
+  Entity *entity = &world->entities[command.entity];
+  switch (command.order) {
+    case Entity_Order::Move_Left: entity_move(entity, -ENEMY_SPEED); break;
+    case Entity_Order::Move_Right: entity_move(entity, ENEMY_SPEED); break;
+    case Entity_Order::Stop: entity_stop(entity); break;
+    case Entity_Order::Jump: entity_jump(entity); break;
+    case Entity_Order::Shoot: entity_shoot(entity, &world->projectiles); break;
+    default: break;
+  }
+}
+
+void apply_tick_input(World *world, const Tick_Input *input) {
+  assert(world);
+  assert(input);
+
+  for (size_t i = 0; i < input->tile_edits_count; ++i) {
+    set_tile(&world->level, input->tile_edits[i].tile, input->tile_edits[i].value);
+  }
+
+  Entity *player = get_player(world);
+  if (input->player.respawn) {
+    respawn_entity(player);
+  }
+
+  if (input->player.move > 0) {
+    entity_move(player, PLAYER_SPEED);
+  } else if (input->player.move < 0) {
+    entity_move(player, -PLAYER_SPEED);
+  } else {
+    entity_stop(player);
+  }
+
+  if (input->player.jump) {
+    entity_jump(player);
+  }
+  if (input->player.shoot) {
+    entity_shoot(player, &world->projectiles);
+  }
+
+  for (size_t i = 0; i < input->commands_count; ++i) {
+    apply_entity_command(world, input->commands[i]);
+  }
+}
+
+void render_world(SDL_Renderer *renderer, const World *world, const Sprite *tile_sprites) {
+  render_level(renderer, &world->level, tile_sprites);
+  for (size_t i = 0; i < world->entities_count; ++i) {
+    render_entity(renderer, world->entities[i]);
+  }
+  render_projectiles(renderer, &world->projectiles);
+}
@@ -0,0 +1,103 @@
+// * ####################
+// * World Batch
+// * ####################
+
+// * Steps many independent worlds across all the cores with a random bot
+// * at the controls of every player. Used for bot testing & balance sweeps.
+
+struct Bot {
+  uint32_t rng;
+};
+
+static inline
+uint32_t xorshift32(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+Bot make_bot(uint32_t seed) {
+  // * xorshift gets stuck on 0
+  return {seed ? seed : 0x9e3779b9};
+}
+
+// * Whether one more step `dir` takes the hitbox past the side of the level.
+// * Ledges inside the level are fine to drop from, past the side there is
+// * nothing to land on.
+static inline
+bool is_level_edge_ahead(const Level *level, const Entity *entity, Entity_Dir dir) {
+  if (is_ground_ahead(level, entity, dir)) return false;
+  const int x = vec2_floor(entity->pos).x + entity->hitbox.x;
+  return dir == Entity_Dir::Right
+    ? x + entity->hitbox.w + 1 >= level_boundary.x + level_boundary.w
+    : x - 1 < level_boundary.x;
+}
+
+Tick_Input bot_input(const World *world, Bot *bot) {
+  const Entity *player = &world->entities[PLAYER_ENTITY];
+  Tick_Input input = {};
+
+  const uint32_t r = xorshift32(&bot->rng);
+  input.player.move = (int)(r % 3) - 1;
+  if (input.player.move != 0) {
+    const Entity_Dir dir = input.player.move > 0 ? Entity_Dir::Right : Entity_Dir::Left;
+    if (is_level_edge_ahead(&world->level, player, dir)) {
+      input.player.move = -input.player.move;
+    }
+  }
+  input.player.jump = (r >> 8) % 60 == 0 && is_entity_on_ground(&world->level, player);
+  input.player.shoot = (r >> 16) % 20 == 0;
+  return input;
+}
+
+const size_t WORLD_BATCH_THREADS_CAPACITY = 256;
+// * Worlds handed to a thread at a time
+const size_t WORLD_BATCH_CHUNK = 16;
+
+// * Runs `ticks` steps of every world, each driven by its own bot.
+// * threads_count == 0 uses all the cores.
+void run_world_batch(World *worlds,
+                     Bot *bots,
+                     size_t worlds_count,
+                     size_t ticks,
+                     Uint64 dt,
+                     size_t threads_count = 0)
+{
+  assert(worlds);
+  assert(bots);
+
+  if (threads_count == 0) {
+    threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads_count = std::min(threads_count, WORLD_BATCH_THREADS_CAPACITY);
+
+  // * Worlds do not share anything, so every thread grabs chunks of them and
+  // * runs all the ticks of a world back to back while it is hot in cache.
+  std::atomic<size_t> next_world = 0;
+  auto worker = [&]() {
+    for (;;) {
+      const size_t begin = next_world.fetch_add(WORLD_BATCH_CHUNK, std::memory_order_relaxed);
+      if (begin >= worlds_count) return;
+      const size_t end = std::min(begin + WORLD_BATCH_CHUNK, worlds_count);
+
+      for (size_t i = begin; i < end; ++i) {
+        for (size_t tick = 0; tick < ticks; ++tick) {
+          const Tick_Input input = bot_input(&worlds[i], &bots[i]);
+          apply_tick_input(&worlds[i], &input);
+          world_step(&worlds[i], dt);
+        }
+      }
+    }
+  };
+
+  std::thread threads[WORLD_BATCH_THREADS_CAPACITY];
+  for (size_t i = 0; i < threads_count; ++i) {
+    threads[i] = std::thread(worker);
+  }
+  for (size_t i = 0; i < threads_count; ++i) {
+    threads[i].join();
+  }
+}